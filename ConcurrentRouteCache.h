@@ -0,0 +1,134 @@
+#ifndef CONCURRENT_ROUTE_CACHE_H
+#define CONCURRENT_ROUTE_CACHE_H
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include "RouteCache.h"
+
+// Access counters of a ConcurrentRouteCache (summed over the shards,
+// a snapshot while workers run is approximate)
+struct RouteCacheStats
+{
+    long long   hits;
+    long long   subpathHits;    // Queries answered by FindSubpath
+    long long   misses;         // Exact key misses (subpath hits too)
+    long long   inserts;
+};
+
+// Thread safe route cache for concurrent query workers.
+//
+// Keys (start vertex, end vertex, QuerySignature) are spread over
+// lock striped shards, each a RouteCache with its own mutex and eviction
+// policy, so workers only contend when they hit the same shard. A hit
+// also touches the policy (it is a write), which is why shards use a
+// plain mutex instead of a reader/writer lock. Searches of a miss run
+// outside of any lock, MultiGraph searches are const and may run in
+// parallel; two workers missing the same key both search it and the
+// second insert is a touch.
+//
+// With "findSubpaths" a query missing its key first looks for a cached
+// route containing it (see RouteCache::FindSubpath). Routes are sharded
+// by their own end points, so every shard is probed; a shard locked by
+// another worker is skipped rather than waited for. It is off by
+// default: on a miss heavy workload the probes touch every shard mutex
+// and take back part of the striping, enable it when the routes share
+// many subpaths (hub and spoke maps).
+//
+// Counters are relaxed atomics on each shard (no ordering is needed,
+// they are only summed by Stats).
+//
+// Graph edits are not synchronized with the queries: stop the workers,
+// edit the graph (directly, the shards do not track dependencies across
+// each other) and call InvalidateTable.
+//
+// USAGE:
+//
+// ConcurrentRouteCache<> cache(graph, 65536);  // 16 shards, LRU
+// ConcurrentRouteCache<> hubs(graph, 65536, 16, true); // and subpaths
+// // on any worker thread
+// cache.ShortestPath(path, "IST", "ESB", true);
+template<class Policy = LRUPolicy>
+class ConcurrentRouteCache
+{
+    private:
+    static const int    DEFAULT_SHARD_COUNT = 16;
+
+    // Aligned so the mutex and the counters of two shards never share a
+    // cache line
+    struct alignas(64) Shard
+    {
+        mutable std::mutex                      lock;
+        RouteCache<GrowableHashTable, Policy>   cache;
+        std::atomic<long long>                  hits;
+        std::atomic<long long>                  subpathHits;
+        std::atomic<long long>                  misses;
+        std::atomic<long long>                  inserts;
+
+        Shard(MultiGraph& graph, int capacity);
+    };
+
+    MultiGraph&                         graph;
+    std::vector<std::unique_ptr<Shard> > shards;
+    int                                 shardBits;
+    bool                                findSubpaths;
+
+    int         ShardIndex(int startInt, int endInt, const QuerySignature& signature) const;
+    Shard&      ShardOf(int startInt, int endInt, const QuerySignature& signature) const;
+    bool        Query(std::vector<int>& orderedVertexEdgeIndexList,
+                      const std::string& vertexNameFrom,
+                      const std::string& vertexNameTo,
+                      const QuerySignature& signature,
+                      const std::vector<std::string>& edgeNames);
+    // Subpath of a cached route on any shard that is not busy
+    bool        FindSubpath(std::vector<int>& orderedVertexEdgeIndexList,
+                            int startInt, int endInt, const QuerySignature& signature);
+
+    protected:
+    public:
+    // Constructors & Destructor
+    // "capacity" is the total route count (0 if unbounded),
+    // "shardCount" is rounded up to a power of two
+    explicit    ConcurrentRouteCache(MultiGraph& graph, int capacity = 0,
+                                     int shardCount = DEFAULT_SHARD_COUNT,
+                                     bool findSubpaths = false);
+
+    const MultiGraph& Graph() const;
+    int         ShardCount() const;
+
+    // Same semantics as RouteCache, thread safe
+    bool        ShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                             const std::string& vertexNameFrom,
+                             const std::string& vertexNameTo,
+                             bool isCostWeighted);
+    bool        HeuristicShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                      const std::string& vertexNameFrom,
+                                      const std::string& vertexNameTo,
+                                      float heuristicWeight);
+    bool        FilteredShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                     const std::string& vertexNameFrom,
+                                     const std::string& vertexNameTo,
+                                     float heuristicWeight,
+                                     const std::vector<std::string>& edgeNames);
+    bool        BiDirectionalShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                          const std::string& vertexNameFrom,
+                                          const std::string& vertexNameTo,
+                                          float heuristicWeight,
+                                          const std::vector<std::string>& edgeNames);
+    bool        Find(std::vector<int>& intArray,
+                     int startInt, int endInt, const QuerySignature& signature,
+                     bool incLRU = false);
+    int         Insert(const std::vector<int>& intArray, const QuerySignature& signature);
+    void        Remove(int startInt, int endInt, const QuerySignature& signature);
+    void        InvalidateTable();
+
+    int         RouteCount() const;
+    RouteCacheStats Stats() const;
+};
+
+// Template Implementation
+#include "ConcurrentRouteCacheImpl.h"
+
+#endif // CONCURRENT_ROUTE_CACHE_H
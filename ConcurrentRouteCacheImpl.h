@@ -0,0 +1,237 @@
+#ifndef CONCURRENT_ROUTE_CACHE_HPP
+#define CONCURRENT_ROUTE_CACHE_HPP
+
+#include <cstdint>
+
+template<class Policy>
+ConcurrentRouteCache<Policy>::Shard::Shard(MultiGraph& graph, int capacity)
+    : cache(graph, capacity)
+    , hits(0)
+    , subpathHits(0)
+    , misses(0)
+    , inserts(0)
+{}
+
+template<class Policy>
+ConcurrentRouteCache<Policy>::ConcurrentRouteCache(MultiGraph& g, int capacity,
+                                                   int shardCount, bool subpaths)
+    : graph(g)
+    , shardBits(0)
+    , findSubpaths(subpaths)
+{
+    while((1 << shardBits) < shardCount) shardBits++;
+    shardCount = 1 << shardBits;
+
+    // Capacity is split evenly (rounded up)
+    int shardCapacity = (capacity + shardCount - 1) / shardCount;
+    for(int i = 0; i < shardCount; i++)
+        shards.push_back(std::unique_ptr<Shard>(new Shard(graph, shardCapacity)));
+}
+
+template<class Policy>
+int ConcurrentRouteCache<Policy>::ShardIndex(int startInt, int endInt, const QuerySignature& signature) const
+{
+    // High bits of a multiplicative hash, the tables of the shards index
+    // with the low bits of their own hash
+    RouteKey key = {startInt, endInt, signature};
+    uint64_t h = static_cast<uint64_t>(RouteKeyHash()(key)) * 0x9E3779B97F4A7C15ull;
+    return (shardBits == 0) ? 0 : static_cast<int>(h >> (64 - shardBits));
+}
+
+template<class Policy>
+typename ConcurrentRouteCache<Policy>::Shard&
+ConcurrentRouteCache<Policy>::ShardOf(int startInt, int endInt, const QuerySignature& signature) const
+{
+    return *shards[ShardIndex(startInt, endInt, signature)];
+}
+
+template<class Policy>
+bool ConcurrentRouteCache<Policy>::FindSubpath(std::vector<int>& orderedVertexEdgeIndexList,
+                                               int startInt, int endInt,
+                                               const QuerySignature& signature)
+{
+    // Routes are spread by their own end points, any shard may hold one
+    // visiting both. A shard held by another worker is skipped instead of
+    // waited for (the query is then searched), so a miss does not queue
+    // on every lock. Probing starts at the shard of the key, workers do
+    // not all try the same shard first.
+    int home = ShardIndex(startInt, endInt, signature);
+    int count = static_cast<int>(shards.size());
+    for(int i = 0; i < count; i++)
+    {
+        Shard& probed = *shards[(home + i) & (count - 1)];
+        std::unique_lock<std::mutex> guard(probed.lock, std::try_to_lock);
+        if(!guard.owns_lock()) continue;
+        if(probed.cache.FindSubpath(orderedVertexEdgeIndexList, startInt, endInt, signature, true))
+        {
+            guard.unlock();
+            shards[home]->subpathHits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+template<class Policy>
+const MultiGraph& ConcurrentRouteCache<Policy>::Graph() const
+{
+    return graph;
+}
+
+template<class Policy>
+int ConcurrentRouteCache<Policy>::ShardCount() const
+{
+    return static_cast<int>(shards.size());
+}
+
+template<class Policy>
+bool ConcurrentRouteCache<Policy>::Query(std::vector<int>& orderedVertexEdgeIndexList,
+                                         const std::string& vertexNameFrom,
+                                         const std::string& vertexNameTo,
+                                         const QuerySignature& signature,
+                                         const std::vector<std::string>& edgeNames)
+{
+    int fromIndex = graph.FindVertexIndex(vertexNameFrom);
+    int toIndex = graph.FindVertexIndex(vertexNameTo);
+
+    if(fromIndex == -1) throw VertexNotFoundException(vertexNameFrom);
+    if(toIndex == -1) throw VertexNotFoundException(vertexNameTo);
+
+    if(Find(orderedVertexEdgeIndexList, fromIndex, toIndex, signature, true))
+        return true;
+    if(findSubpaths && FindSubpath(orderedVertexEdgeIndexList, fromIndex, toIndex, signature))
+        return true;
+
+    // Searched without holding the shard, unreachable pairs are not cached
+    std::vector<int> path;
+    if(!RouteCache<GrowableHashTable, Policy>::Search(graph, path, vertexNameFrom, vertexNameTo,
+                                                      signature, edgeNames))
+        return false;
+
+    Insert(path, signature);
+    orderedVertexEdgeIndexList.insert(orderedVertexEdgeIndexList.end(),
+                                      path.begin(), path.end());
+    return true;
+}
+
+template<class Policy>
+bool ConcurrentRouteCache<Policy>::ShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                                const std::string& vertexNameFrom,
+                                                const std::string& vertexNameTo,
+                                                bool isCostWeighted)
+{
+    return Query(orderedVertexEdgeIndexList, vertexNameFrom, vertexNameTo,
+                 QuerySignature(isCostWeighted), std::vector<std::string>());
+}
+
+template<class Policy>
+bool ConcurrentRouteCache<Policy>::HeuristicShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                                         const std::string& vertexNameFrom,
+                                                         const std::string& vertexNameTo,
+                                                         float heuristicWeight)
+{
+    std::vector<std::string> noFilter;
+    return Query(orderedVertexEdgeIndexList, vertexNameFrom, vertexNameTo,
+                 QuerySignature::Make(QUERY_HEURISTIC, heuristicWeight, noFilter), noFilter);
+}
+
+template<class Policy>
+bool ConcurrentRouteCache<Policy>::FilteredShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                                        const std::string& vertexNameFrom,
+                                                        const std::string& vertexNameTo,
+                                                        float heuristicWeight,
+                                                        const std::vector<std::string>& edgeNames)
+{
+    return Query(orderedVertexEdgeIndexList, vertexNameFrom, vertexNameTo,
+                 QuerySignature::Make(QUERY_FILTERED, heuristicWeight, edgeNames), edgeNames);
+}
+
+template<class Policy>
+bool ConcurrentRouteCache<Policy>::BiDirectionalShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                                             const std::string& vertexNameFrom,
+                                                             const std::string& vertexNameTo,
+                                                             float heuristicWeight,
+                                                             const std::vector<std::string>& edgeNames)
+{
+    return Query(orderedVertexEdgeIndexList, vertexNameFrom, vertexNameTo,
+                 QuerySignature::Make(QUERY_BIDIRECTIONAL, heuristicWeight, edgeNames), edgeNames);
+}
+
+template<class Policy>
+bool ConcurrentRouteCache<Policy>::Find(std::vector<int>& intArray,
+                                        int startInt, int endInt, const QuerySignature& signature,
+                                        bool incLRU)
+{
+    Shard& shard = ShardOf(startInt, endInt, signature);
+    bool found;
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        found = shard.cache.Find(intArray, startInt, endInt, signature, incLRU);
+    }
+
+    if(found) shard.hits.fetch_add(1, std::memory_order_relaxed);
+    else shard.misses.fetch_add(1, std::memory_order_relaxed);
+    return found;
+}
+
+template<class Policy>
+int ConcurrentRouteCache<Policy>::Insert(const std::vector<int>& intArray, const QuerySignature& signature)
+{
+    if(intArray.size() < 1) throw InvalidTableArgException();
+
+    Shard& shard = ShardOf(intArray[0], intArray[intArray.size() - 1], signature);
+    int result;
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        result = shard.cache.Insert(intArray, signature);
+    }
+
+    if(result == 0) shard.inserts.fetch_add(1, std::memory_order_relaxed);
+    return result;
+}
+
+template<class Policy>
+void ConcurrentRouteCache<Policy>::Remove(int startInt, int endInt, const QuerySignature& signature)
+{
+    Shard& shard = ShardOf(startInt, endInt, signature);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    shard.cache.Remove(startInt, endInt, signature);
+}
+
+template<class Policy>
+void ConcurrentRouteCache<Policy>::InvalidateTable()
+{
+    for(size_t i = 0; i < shards.size(); i++)
+    {
+        std::lock_guard<std::mutex> guard(shards[i]->lock);
+        shards[i]->cache.InvalidateTable();
+    }
+}
+
+template<class Policy>
+int ConcurrentRouteCache<Policy>::RouteCount() const
+{
+    int count = 0;
+    for(size_t i = 0; i < shards.size(); i++)
+    {
+        std::lock_guard<std::mutex> guard(shards[i]->lock);
+        count += shards[i]->cache.RouteCount();
+    }
+    return count;
+}
+
+template<class Policy>
+RouteCacheStats ConcurrentRouteCache<Policy>::Stats() const
+{
+    RouteCacheStats stats = {0, 0, 0, 0};
+    for(size_t i = 0; i < shards.size(); i++)
+    {
+        stats.hits += shards[i]->hits.load(std::memory_order_relaxed);
+        stats.subpathHits += shards[i]->subpathHits.load(std::memory_order_relaxed);
+        stats.misses += shards[i]->misses.load(std::memory_order_relaxed);
+        stats.inserts += shards[i]->inserts.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+#endif // CONCURRENT_ROUTE_CACHE_HPP
@@ -0,0 +1,419 @@
+#include "ContractionHierarchy.h"
+#include "MultiGraph.h"
+#include "Exceptions.h"
+#include "IntPair.h"
+#include <limits>
+
+#define INF std::numeric_limits<float>::infinity()
+// Witness searches give up after settling this many vertices,
+// (giving up only adds an unnecessary shortcut, never a wrong one)
+#define WITNESS_SETTLE_LIMIT 500
+
+// Contraction state, only alive during the construction
+class ContractionHierarchy::Builder
+{
+    private:
+    ContractionHierarchy&           ch;
+    int                             size;
+    // Edges between not yet contracted vertices (edge ids)
+    std::vector<std::vector<int> >  outEdges;
+    std::vector<std::vector<int> >  inEdges;
+    std::vector<char>               contracted;
+    std::vector<int>                contractedNeighbours;
+    // Witness search scratch (reset through "touched")
+    std::vector<float>              distance;
+    std::vector<int>                touched;
+    // Lightest edge to each neighbour (reset after each contraction)
+    std::vector<int>                bestIn;
+    std::vector<int>                bestOut;
+
+    int         AddEdge(int source, int target, float weight,
+                        int edgeSlot, int firstHalf, int secondHalf);
+    void        WitnessSearch(int source, int excluded, float maxDistance);
+    void        ResetWitness();
+    int         Contract(int v, bool simulate, int& removedCount);
+    int         Priority(int v);
+
+    public:
+                Builder(ContractionHierarchy& ch,
+                        const std::vector<GraphVertex>& vertexList);
+    void        Run();
+};
+
+ContractionHierarchy::Builder::Builder(ContractionHierarchy& ch,
+                                       const std::vector<GraphVertex>& vertexList)
+    : ch(ch)
+    , size(static_cast<int>(vertexList.size()))
+    , outEdges(size)
+    , inEdges(size)
+    , contracted(size, 0)
+    , contractedNeighbours(size, 0)
+    , distance(size, INF)
+    , bestIn(size, -1)
+    , bestOut(size, -1)
+{
+    // Only the lightest of the parallel edges can be on a shortest path
+    for(int u = 0; u < size; u++)
+    {
+        const std::vector<GraphEdge>& edges = vertexList[u].edges;
+        std::vector<int> lightest;
+        for(int j = 0; j < static_cast<int>(edges.size()); j++)
+        {
+            int v = edges[j].endVertexIndex;
+            if(v == u) continue;
+
+            float w = MultiGraph::Lerp(edges[j].weight[0], edges[j].weight[1],
+                                       ch.heuristicWeight);
+            if(bestOut[v] == -1)
+            {
+                bestOut[v] = j;
+                lightest.push_back(v);
+            }
+            else
+            {
+                const GraphEdge& best = edges[bestOut[v]];
+                if(w < MultiGraph::Lerp(best.weight[0], best.weight[1],
+                                        ch.heuristicWeight))
+                    bestOut[v] = j;
+            }
+        }
+
+        for(size_t i = 0; i < lightest.size(); i++)
+        {
+            int v = lightest[i];
+            const GraphEdge& edge = edges[bestOut[v]];
+            AddEdge(u, v, MultiGraph::Lerp(edge.weight[0], edge.weight[1],
+                                           ch.heuristicWeight),
+                    bestOut[v], -1, -1);
+            bestOut[v] = -1;
+        }
+    }
+}
+
+int ContractionHierarchy::Builder::AddEdge(int source, int target, float weight,
+                                           int edgeSlot, int firstHalf, int secondHalf)
+{
+    HierarchyEdge edge = {source, target, weight, edgeSlot, firstHalf, secondHalf};
+    int id = static_cast<int>(ch.edges.size());
+
+    ch.edges.push_back(edge);
+    outEdges[source].push_back(id);
+    inEdges[target].push_back(id);
+    return id;
+}
+
+void ContractionHierarchy::Builder::WitnessSearch(int source, int excluded,
+                                                  float maxDistance)
+{
+    MinPairHeap<float, int> pq;
+    int settled = 0;
+
+    distance[source] = 0;
+    touched.push_back(source);
+    pq.push(Pair<float, int>{0, source});
+    while(!pq.empty())
+    {
+        float dist = pq.top().key;
+        int curr = pq.top().value;
+        pq.pop();
+
+        if(dist > distance[curr]) continue;
+        if(dist > maxDistance || ++settled > WITNESS_SETTLE_LIMIT) break;
+
+        const std::vector<int>& out = outEdges[curr];
+        for(size_t i = 0; i < out.size(); i++)
+        {
+            const HierarchyEdge& edge = ch.edges[out[i]];
+            int next = edge.target;
+            if(next == excluded || contracted[next]) continue;
+
+            if(dist + edge.weight < distance[next])
+            {
+                if(distance[next] == INF) touched.push_back(next);
+                distance[next] = dist + edge.weight;
+                pq.push(Pair<float, int>{dist + edge.weight, next});
+            }
+        }
+    }
+}
+
+void ContractionHierarchy::Builder::ResetWitness()
+{
+    for(size_t i = 0; i < touched.size(); i++)
+        distance[touched[i]] = INF;
+    touched.clear();
+}
+
+int ContractionHierarchy::Builder::Contract(int v, bool simulate, int& removedCount)
+{
+    // Lightest active edges around "v" (one per neighbour)
+    std::vector<int> ins, outs;
+    float maxOut = 0;
+    for(size_t i = 0; i < inEdges[v].size(); i++)
+    {
+        int id = inEdges[v][i];
+        int u = ch.edges[id].source;
+        if(contracted[u]) continue;
+
+        if(bestIn[u] == -1) ins.push_back(u);
+        if(bestIn[u] == -1 || ch.edges[id].weight < ch.edges[bestIn[u]].weight)
+            bestIn[u] = id;
+    }
+    for(size_t i = 0; i < outEdges[v].size(); i++)
+    {
+        int id = outEdges[v][i];
+        int x = ch.edges[id].target;
+        if(contracted[x]) continue;
+
+        if(bestOut[x] == -1) outs.push_back(x);
+        if(bestOut[x] == -1 || ch.edges[id].weight < ch.edges[bestOut[x]].weight)
+            bestOut[x] = id;
+        if(ch.edges[bestOut[x]].weight > maxOut) maxOut = ch.edges[bestOut[x]].weight;
+    }
+
+    // A shortcut "u -> x" is needed when "u -> v -> x" is the only
+    // shortest path (no witness path avoiding "v")
+    int shortcuts = 0;
+    for(size_t i = 0; i < ins.size(); i++)
+    {
+        int u = ins[i];
+        int inId = bestIn[u];
+        float w1 = ch.edges[inId].weight;
+
+        WitnessSearch(u, v, w1 + maxOut);
+        for(size_t j = 0; j < outs.size(); j++)
+        {
+            int x = outs[j];
+            if(x == u) continue;
+
+            int outId = bestOut[x];
+            float w = w1 + ch.edges[outId].weight;
+            if(distance[x] <= w) continue;
+
+            shortcuts++;
+            if(!simulate)
+            {
+                AddEdge(u, x, w, -1, inId, outId);
+                ch.shortcutCount++;
+            }
+        }
+        ResetWitness();
+    }
+
+    // Bookkeeping of the neighbours
+    for(size_t i = 0; i < ins.size(); i++)
+    {
+        if(!simulate) contractedNeighbours[ins[i]]++;
+        bestIn[ins[i]] = -1;
+    }
+    for(size_t j = 0; j < outs.size(); j++)
+    {
+        if(!simulate) contractedNeighbours[outs[j]]++;
+        bestOut[outs[j]] = -1;
+    }
+
+    removedCount = static_cast<int>(ins.size() + outs.size());
+    return shortcuts;
+}
+
+int ContractionHierarchy::Builder::Priority(int v)
+{
+    // Edge difference + contracted neighbours (spreads the contraction)
+    int removedCount;
+    int shortcuts = Contract(v, true, removedCount);
+    return shortcuts - removedCount + contractedNeighbours[v];
+}
+
+void ContractionHierarchy::Builder::Run()
+{
+    MinPairHeap<int, int> queue;
+    for(int v = 0; v < size; v++)
+        queue.push(Pair<int, int>{Priority(v), v});
+
+    // Lazy updates: priority is recomputed on pop and the vertex is
+    // pushed back if it is not the minimum anymore
+    int order = 0;
+    while(!queue.empty())
+    {
+        int v = queue.top().value;
+        queue.pop();
+        if(contracted[v]) continue;
+
+        int priority = Priority(v);
+        if(!queue.empty() && priority > queue.top().key)
+        {
+            queue.push(Pair<int, int>{priority, v});
+            continue;
+        }
+
+        int removedCount;
+        Contract(v, false, removedCount);
+        contracted[v] = 1;
+        ch.rank[v] = order++;
+    }
+}
+
+ContractionHierarchy::ContractionHierarchy()
+    : heuristicWeight(0)
+    , forwardOffsets(1, 0)
+    , backwardOffsets(1, 0)
+    , shortcutCount(0)
+{}
+
+ContractionHierarchy::ContractionHierarchy(const MultiGraph& graph,
+                                           float heuristicWeight)
+    : heuristicWeight(heuristicWeight)
+    , vertexIndex(graph.vertexIndex)
+    , rank(graph.vertexList.size(), 0)
+    , shortcutCount(0)
+{
+    Builder builder(*this, graph.vertexList);
+    builder.Run();
+    BuildSearchGraphs();
+}
+
+void ContractionHierarchy::BuildSearchGraphs()
+{
+    int size = static_cast<int>(rank.size());
+    forwardOffsets.assign(size + 1, 0);
+    backwardOffsets.assign(size + 1, 0);
+
+    // Count, prefix sum, then fill
+    for(size_t e = 0; e < edges.size(); e++)
+    {
+        const HierarchyEdge& edge = edges[e];
+        if(rank[edge.target] > rank[edge.source]) forwardOffsets[edge.source + 1]++;
+        else backwardOffsets[edge.target + 1]++;
+    }
+    for(int v = 0; v < size; v++)
+    {
+        forwardOffsets[v + 1] += forwardOffsets[v];
+        backwardOffsets[v + 1] += backwardOffsets[v];
+    }
+
+    forwardEdges.resize(forwardOffsets[size]);
+    backwardEdges.resize(backwardOffsets[size]);
+    std::vector<int> forwardFill(forwardOffsets.begin(), forwardOffsets.end() - 1);
+    std::vector<int> backwardFill(backwardOffsets.begin(), backwardOffsets.end() - 1);
+    for(size_t e = 0; e < edges.size(); e++)
+    {
+        const HierarchyEdge& edge = edges[e];
+        if(rank[edge.target] > rank[edge.source])
+            forwardEdges[forwardFill[edge.source]++] = static_cast<int>(e);
+        else
+            backwardEdges[backwardFill[edge.target]++] = static_cast<int>(e);
+    }
+}
+
+void ContractionHierarchy::Unpack(std::vector<int>& orderedVertexEdgeIndexList,
+                                  int edgeId) const
+{
+    const HierarchyEdge& edge = edges[edgeId];
+    if(edge.firstHalf == -1)
+    {
+        orderedVertexEdgeIndexList.push_back(edge.edgeSlot);
+        orderedVertexEdgeIndexList.push_back(edge.target);
+        return;
+    }
+    Unpack(orderedVertexEdgeIndexList, edge.firstHalf);
+    Unpack(orderedVertexEdgeIndexList, edge.secondHalf);
+}
+
+float ContractionHierarchy::HeuristicWeight() const
+{
+    return heuristicWeight;
+}
+
+int ContractionHierarchy::ShortcutCount() const
+{
+    return shortcutCount;
+}
+
+bool ContractionHierarchy::ShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                        const std::string& vertexNameFrom,
+                                        const std::string& vertexNameTo,
+                                        SearchStats* stats) const
+{
+    std::unordered_map<std::string, int>::const_iterator it;
+    it = vertexIndex.find(vertexNameFrom);
+    if(it == vertexIndex.end()) throw VertexNotFoundException(vertexNameFrom);
+    int fromIndex = it->second;
+    it = vertexIndex.find(vertexNameTo);
+    if(it == vertexIndex.end()) throw VertexNotFoundException(vertexNameTo);
+    int toIndex = it->second;
+
+    int size = static_cast<int>(rank.size());
+    // Index 0 is the forward search, 1 is the backward search
+    std::vector<float> distance[2] = {std::vector<float>(size, INF),
+                                      std::vector<float>(size, INF)};
+    std::vector<int> previousEdge[2] = {std::vector<int>(size, -1),
+                                        std::vector<int>(size, -1)};
+    const std::vector<int>* offsets[2] = {&forwardOffsets, &backwardOffsets};
+    const std::vector<int>* searchEdges[2] = {&forwardEdges, &backwardEdges};
+    MinPairHeap<float, int> pq[2];
+    SearchStats s = {0, 0};
+
+    distance[0][fromIndex] = 0;
+    distance[1][toIndex] = 0;
+    pq[0].push(Pair<float, int>{0, fromIndex});
+    pq[1].push(Pair<float, int>{0, toIndex});
+    s.pushCount += 2;
+
+    float best = (fromIndex == toIndex) ? 0 : INF;
+    int meet = (fromIndex == toIndex) ? fromIndex : -1;
+
+    // Both searches only go upwards, they can not stop at the first
+    // meeting; a side stops once its minimum reaches the best path.
+    int side = 0;
+    while(true)
+    {
+        bool forwardDone = pq[0].empty() || pq[0].top().key >= best;
+        bool backwardDone = pq[1].empty() || pq[1].top().key >= best;
+        if(forwardDone && backwardDone) break;
+
+        if(forwardDone) side = 1;
+        else if(backwardDone) side = 0;
+        else side = 1 - side;
+
+        float dist = pq[side].top().key;
+        int curr = pq[side].top().value;
+        pq[side].pop();
+        if(dist > distance[side][curr]) continue;
+        s.settledCount++;
+
+        for(int i = (*offsets[side])[curr]; i < (*offsets[side])[curr + 1]; i++)
+        {
+            int e = (*searchEdges[side])[i];
+            const HierarchyEdge& edge = edges[e];
+            int next = (side == 0) ? edge.target : edge.source;
+            if(dist + edge.weight < distance[side][next])
+            {
+                distance[side][next] = dist + edge.weight;
+                previousEdge[side][next] = e;
+                pq[side].push(Pair<float, int>{dist + edge.weight, next});
+                s.pushCount++;
+            }
+            if(distance[0][next] + distance[1][next] < best)
+            {
+                best = distance[0][next] + distance[1][next];
+                meet = next;
+            }
+        }
+    }
+
+    if(stats) *stats = s;
+    if(meet == -1) return false;
+
+    // Source -> meet (collected backwards), then meet -> target
+    std::vector<int> forwardChain;
+    for(int v = meet; v != fromIndex; v = edges[previousEdge[0][v]].source)
+        forwardChain.push_back(previousEdge[0][v]);
+
+    orderedVertexEdgeIndexList.push_back(fromIndex);
+    for(int i = static_cast<int>(forwardChain.size()) - 1; i >= 0; i--)
+        Unpack(orderedVertexEdgeIndexList, forwardChain[i]);
+    for(int v = meet; v != toIndex; v = edges[previousEdge[1][v]].target)
+        Unpack(orderedVertexEdgeIndexList, previousEdge[1][v]);
+
+    return true;
+}
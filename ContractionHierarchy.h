@@ -0,0 +1,74 @@
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+class MultiGraph;
+struct SearchStats;
+
+// Contraction hierarchy of a MultiGraph for a single fixed blend
+// (heuristicWeight).
+//
+// Vertices are contracted in order of importance, shortcuts are added
+// when a contracted vertex lies on the only shortest path between its
+// neighbours. Queries then run a bidirectional Dijkstra that only goes
+// "upwards" in the hierarchy.
+//
+// Every shortcut remembers its two halves, so a query result is unpacked
+// to original edges and reported in the same "orderedVertexEdgeIndexList"
+// format as MultiGraph (local edge indices of the source graph).
+// Among parallel edges the lightest one (for the blend) is used.
+//
+// Hierarchy does not track its source, it should be rebuilt after the
+// graph is modified.
+class ContractionHierarchy
+{
+    private:
+    struct HierarchyEdge
+    {
+        int         source;
+        int         target;
+        float       weight;
+        int         edgeSlot;   // Local edge index on "source" (original edges)
+        int         firstHalf;  // Edge ids of the halves (-1 on original edges)
+        int         secondHalf;
+    };
+
+    float                                   heuristicWeight;
+    std::unordered_map<std::string, int>    vertexIndex;
+    std::vector<int>                        rank;
+    std::vector<HierarchyEdge>              edges;
+    // Upward search graphs (CSR, values are edge ids)
+    //  forward : edges "v -> w" stored on v where rank[w] > rank[v]
+    //  backward: edges "w -> v" stored on v where rank[w] > rank[v]
+    std::vector<int>                        forwardOffsets;
+    std::vector<int>                        forwardEdges;
+    std::vector<int>                        backwardOffsets;
+    std::vector<int>                        backwardEdges;
+    int                                     shortcutCount;
+
+    // Build helpers
+    class Builder;
+    void        BuildSearchGraphs();
+    void        Unpack(std::vector<int>& orderedVertexEdgeIndexList,
+                       int edgeId) const;
+
+    protected:
+    public:
+    // Constructors & Destructor
+                ContractionHierarchy();
+                ContractionHierarchy(const MultiGraph& graph,
+                                     float heuristicWeight);
+
+    float       HeuristicWeight() const;
+    int         ShortcutCount() const;
+
+    bool        ShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                             const std::string& vertexNameFrom,
+                             const std::string& vertexNameTo,
+                             SearchStats* stats = NULL) const;
+};
+
+#endif // CONTRACTION_HIERARCHY_H
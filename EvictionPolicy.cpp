@@ -0,0 +1,250 @@
+#include "EvictionPolicy.h"
+#include <cstddef>
+
+HandleLists::HandleLists(int listCount)
+    : listCount(listCount)
+{
+    Clear();
+}
+
+void HandleLists::Grow(int handle)
+{
+    int node = listCount + handle;
+    if(node < static_cast<int>(next.size())) return;
+
+    // Unlinked nodes point to themselves
+    int oldSize = static_cast<int>(next.size());
+    int newSize = node + 1;
+    if(newSize < 2 * oldSize) newSize = 2 * oldSize;
+    prev.resize(newSize);
+    next.resize(newSize);
+    for(int i = oldSize; i < newSize; i++)
+    {
+        prev[i] = i;
+        next[i] = i;
+    }
+}
+
+void HandleLists::Clear()
+{
+    prev.resize(listCount);
+    next.resize(listCount);
+    for(int i = 0; i < listCount; i++)
+    {
+        prev[i] = i;
+        next[i] = i;
+    }
+}
+
+void HandleLists::PushFront(int list, int handle)
+{
+    Grow(handle);
+
+    int node = listCount + handle;
+    int first = next[list];
+    prev[node] = list;
+    next[node] = first;
+    prev[first] = node;
+    next[list] = node;
+}
+
+void HandleLists::Unlink(int handle)
+{
+    int node = listCount + handle;
+    if(node >= static_cast<int>(next.size())) return;
+
+    next[prev[node]] = next[node];
+    prev[next[node]] = prev[node];
+    prev[node] = node;
+    next[node] = node;
+}
+
+int HandleLists::Back(int list) const
+{
+    int node = prev[list];
+    return (node == list) ? -1 : node - listCount;
+}
+
+bool HandleLists::Empty(int list) const
+{
+    return next[list] == list;
+}
+
+void HandleLists::Collect(std::vector<int>& handles, int list) const
+{
+    for(int node = prev[list]; node != list; node = prev[node])
+        handles.push_back(node - listCount);
+}
+
+LRUPolicy::LRUPolicy()
+    : order(1)
+{}
+
+void LRUPolicy::Insert(int handle)
+{
+    order.PushFront(0, handle);
+}
+
+void LRUPolicy::Touch(int handle)
+{
+    order.Unlink(handle);
+    order.PushFront(0, handle);
+}
+
+void LRUPolicy::Remove(int handle)
+{
+    order.Unlink(handle);
+}
+
+int LRUPolicy::Victim()
+{
+    int handle = order.Back(0);
+    if(handle != -1) order.Unlink(handle);
+    return handle;
+}
+
+void LRUPolicy::Clear()
+{
+    order.Clear();
+}
+
+ClockPolicy::ClockPolicy()
+    : hand(0)
+    , count(0)
+{}
+
+void ClockPolicy::Insert(int handle)
+{
+    if(handle >= static_cast<int>(present.size()))
+    {
+        present.resize(handle + 1, 0);
+        referenced.resize(handle + 1, 0);
+    }
+
+    // A new entry gets its second chance like a used one
+    present[handle] = 1;
+    referenced[handle] = 1;
+    count++;
+}
+
+void ClockPolicy::Touch(int handle)
+{
+    referenced[handle] = 1;
+}
+
+void ClockPolicy::Remove(int handle)
+{
+    if(handle >= static_cast<int>(present.size()) || !present[handle]) return;
+
+    present[handle] = 0;
+    count--;
+}
+
+int ClockPolicy::Victim()
+{
+    if(count == 0) return -1;
+
+    // Clears the reference bits on the way, at most one full turn
+    // before finding an unreferenced entry
+    int size = static_cast<int>(present.size());
+    for(;; hand++)
+    {
+        if(hand >= size) hand = 0;
+        if(!present[hand]) continue;
+
+        if(referenced[hand])
+        {
+            referenced[hand] = 0;
+            continue;
+        }
+
+        int handle = hand++;
+        present[handle] = 0;
+        count--;
+        return handle;
+    }
+}
+
+void ClockPolicy::Clear()
+{
+    present.clear();
+    referenced.clear();
+    hand = 0;
+    count = 0;
+}
+
+LFUPolicy::LFUPolicy()
+    : buckets(MAX_FREQUENCY + 1)
+    , count(0)
+    , touchCount(0)
+{}
+
+void LFUPolicy::Age()
+{
+    // Halves every counter so old popularity fades, buckets are merged
+    // (2f and 2f + 1 into f) keeping the recency order of each
+    std::vector<int> handles;
+    for(int f = 1; f <= MAX_FREQUENCY; f++)
+    {
+        handles.clear();
+        buckets.Collect(handles, f);
+        for(size_t i = 0; i < handles.size(); i++)
+        {
+            int handle = handles[i];
+            frequency[handle] = static_cast<unsigned char>(f / 2);
+            buckets.Unlink(handle);
+            buckets.PushFront(f / 2, handle);
+        }
+    }
+    touchCount = 0;
+}
+
+void LFUPolicy::Insert(int handle)
+{
+    if(handle >= static_cast<int>(frequency.size())) frequency.resize(handle + 1, 0);
+
+    frequency[handle] = 1;
+    buckets.PushFront(1, handle);
+    count++;
+}
+
+void LFUPolicy::Touch(int handle)
+{
+    int f = frequency[handle];
+    if(f < MAX_FREQUENCY) f++;
+    frequency[handle] = static_cast<unsigned char>(f);
+
+    buckets.Unlink(handle);
+    buckets.PushFront(f, handle);
+
+    if(++touchCount >= AGING_PERIOD * count) Age();
+}
+
+void LFUPolicy::Remove(int handle)
+{
+    buckets.Unlink(handle);
+    count--;
+}
+
+int LFUPolicy::Victim()
+{
+    // Least recently used of the lowest frequency
+    for(int f = 0; f <= MAX_FREQUENCY; f++)
+    {
+        int handle = buckets.Back(f);
+        if(handle == -1) continue;
+
+        buckets.Unlink(handle);
+        count--;
+        return handle;
+    }
+    return -1;
+}
+
+void LFUPolicy::Clear()
+{
+    buckets.Clear();
+    frequency.clear();
+    count = 0;
+    touchCount = 0;
+}
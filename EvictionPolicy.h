@@ -0,0 +1,117 @@
+#ifndef EVICTION_POLICY_H
+#define EVICTION_POLICY_H
+
+#include <vector>
+
+// Eviction policies of the route cache.
+//
+// Entries are identified by small non negative handles (the cache
+// reuses the handles of the evicted entries so they stay dense). Every
+// policy has the same interface:
+//
+// Insert(handle) : new entry
+// Touch(handle)  : entry is used (cache hit)
+// Remove(handle) : entry is dropped by the cache (invalidation)
+// Victim()       : picks and forgets the entry to evict (-1 if none)
+// Clear()
+//
+// LRUPolicy    : least recently used, O(1) per operation
+// ClockPolicy  : second chance, amortized O(1) victim
+// LFUPolicy    : least frequently used with aging, O(1) per operation
+//                (amortized with the aging)
+
+// Doubly linked lists over handles, a handle is on at most one list.
+// Each list is circular with a head node, heads are the first
+// "listCount" nodes, handle "h" is the node "listCount + h".
+class HandleLists
+{
+    private:
+    std::vector<int>    prev;
+    std::vector<int>    next;
+    int                 listCount;
+
+    void        Grow(int handle);
+
+    protected:
+    public:
+    // Constructors & Destructor
+    explicit    HandleLists(int listCount);
+
+    void        Clear();
+    void        PushFront(int list, int handle);
+    void        Unlink(int handle);
+    // Least recently pushed handle (-1 if the list is empty)
+    int         Back(int list) const;
+    bool        Empty(int list) const;
+    // Handles of the list, least recently pushed first
+    void        Collect(std::vector<int>& handles, int list) const;
+};
+
+class LRUPolicy
+{
+    private:
+    // Most recently used at the front
+    HandleLists         order;
+
+    protected:
+    public:
+    // Constructors & Destructor
+                LRUPolicy();
+
+    void        Insert(int handle);
+    void        Touch(int handle);
+    void        Remove(int handle);
+    int         Victim();
+    void        Clear();
+};
+
+class ClockPolicy
+{
+    private:
+    // Per handle, the hand sweeps the handles in order
+    std::vector<unsigned char>  present;
+    std::vector<unsigned char>  referenced;
+    int                         hand;
+    int                         count;
+
+    protected:
+    public:
+    // Constructors & Destructor
+                ClockPolicy();
+
+    void        Insert(int handle);
+    void        Touch(int handle);
+    void        Remove(int handle);
+    int         Victim();
+    void        Clear();
+};
+
+class LFUPolicy
+{
+    private:
+    // Counters saturate, a victim is found in at most that many steps
+    static const int    MAX_FREQUENCY = 15;
+    // Counters are halved after "AGING_PERIOD * entry count" touches
+    static const int    AGING_PERIOD = 8;
+
+    // One list per frequency, most recently used at the front
+    HandleLists                 buckets;
+    std::vector<unsigned char>  frequency;
+    int                         count;
+    int                         touchCount;
+
+    void        Age();
+
+    protected:
+    public:
+    // Constructors & Destructor
+                LFUPolicy();
+
+    void        Insert(int handle);
+    void        Touch(int handle);
+    void        Remove(int handle);
+    int         Victim();
+    void        Clear();
+};
+
+#endif // EVICTION_POLICY_H
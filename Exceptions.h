@@ -2,6 +2,7 @@
 #define EXCEPTIONS_H
 
 #include <string>
+#include <vector>
 #include <sstream>
 
 //==========================//
@@ -52,6 +53,18 @@ struct SameNamedEdgeException
     std::string     ToString();
 };
 
+// Every error found by GraphBuilder::Build (one message per error)
+struct GraphBuildException
+{
+    private:
+    std::vector<std::string>    messages;
+
+    public:
+                    GraphBuildException(const std::vector<std::string>& messages);
+    const std::vector<std::string>& Messages() const;
+    std::string     ToString();
+};
+
 inline DuplicateVertexException::DuplicateVertexException(const std::string& vn)
     : vertexName(vn)
 {}
@@ -104,6 +117,24 @@ inline std::string SameNamedEdgeException::ToString()
     return ss.str();
 }
 
+inline GraphBuildException::GraphBuildException(const std::vector<std::string>& m)
+    : messages(m)
+{}
+
+inline const std::vector<std::string>& GraphBuildException::Messages() const
+{
+    return messages;
+}
+
+inline std::string GraphBuildException::ToString()
+{
+    std::stringstream ss;
+    ss << "Graph can not be built (" << messages.size() << " errors).";
+    for(size_t i = 0; i < messages.size(); i++)
+        ss << "\n" << messages[i];
+    return ss.str();
+}
+
 //==========================//
 // TABLE RELATED EXCEPTIONS //
 //==========================//
@@ -0,0 +1,616 @@
+#include "FrozenGraph.h"
+#include "MultiGraph.h"
+#include "Exceptions.h"
+#include "IndexedHeap.h"
+#include <iostream>
+#include <fstream>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define INF std::numeric_limits<float>::infinity()
+
+// Binary image layout (native byte order, every section is 4-byte aligned)
+//
+//  ImageHeader
+//  vertexNameOffsets   uint32 [|V| + 1]
+//  vertexSortedIds     uint32 [namedVertexCount] (removed vertices are left out)
+//  edgeNameOffsets     uint32 [|N| + 1]
+//  edgeNameSortedIds   uint32 [|N|]
+//  edgeOffsets         int32  [|V| + 1]
+//  edgeTargets         int32  [|E|]
+//  edgeNameIds         int32  [|E|]
+//  edgeWeight0         float  [|E|]
+//  edgeWeight1         float  [|E|]
+//  strings             char   [stringBytes] (not null terminated)
+//
+// Offsets on the header are in bytes from the start of the image.
+namespace
+{
+    const char          IMAGE_MAGIC[8] = {'F', 'F', 'G', 'R', 'A', 'P', 'H', '\0'};
+    const unsigned int  IMAGE_VERSION = 2;
+
+    enum ImageSection
+    {
+        VERTEX_NAME_OFFSETS,
+        VERTEX_SORTED_IDS,
+        EDGE_NAME_OFFSETS,
+        EDGE_NAME_SORTED_IDS,
+        EDGE_OFFSETS,
+        EDGE_TARGETS,
+        EDGE_NAME_IDS,
+        EDGE_WEIGHT_0,
+        EDGE_WEIGHT_1,
+        STRINGS,
+        SECTION_COUNT
+    };
+
+    struct ImageHeader
+    {
+        char                magic[8];
+        unsigned int        version;
+        unsigned int        vertexCount;
+        unsigned int        edgeCount;
+        unsigned int        edgeNameCount;
+        unsigned int        stringBytes;
+        unsigned int        namedVertexCount;
+        unsigned long long  sectionOffset[SECTION_COUNT];
+        unsigned long long  imageSize;
+    };
+
+    size_t Align4(size_t size)
+    {
+        return (size + 3) & ~static_cast<size_t>(3);
+    }
+
+    // Byte sizes of the sections for the given counts
+    void SectionSizes(size_t sizes[SECTION_COUNT],
+                      size_t vertexCount, size_t namedVertexCount,
+                      size_t edgeCount, size_t edgeNameCount,
+                      size_t stringBytes)
+    {
+        sizes[VERTEX_NAME_OFFSETS]  = (vertexCount + 1) * sizeof(unsigned int);
+        sizes[VERTEX_SORTED_IDS]    = namedVertexCount * sizeof(unsigned int);
+        sizes[EDGE_NAME_OFFSETS]    = (edgeNameCount + 1) * sizeof(unsigned int);
+        sizes[EDGE_NAME_SORTED_IDS] = edgeNameCount * sizeof(unsigned int);
+        sizes[EDGE_OFFSETS]         = (vertexCount + 1) * sizeof(int);
+        sizes[EDGE_TARGETS]         = edgeCount * sizeof(int);
+        sizes[EDGE_NAME_IDS]        = edgeCount * sizeof(int);
+        sizes[EDGE_WEIGHT_0]        = edgeCount * sizeof(float);
+        sizes[EDGE_WEIGHT_1]        = edgeCount * sizeof(float);
+        sizes[STRINGS]              = stringBytes;
+    }
+
+    // Name offsets ("count" + 1) are non decreasing and inside the string
+    // table, sorted ids ("idCount") refer to one of the names
+    bool ValidNames(const unsigned int* offsets, size_t count,
+                    const unsigned int* sortedIds, size_t idCount,
+                    size_t stringBytes)
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            if(offsets[i] > offsets[i + 1]) return false;
+        }
+        if(offsets[count] > stringBytes) return false;
+
+        for(size_t i = 0; i < idCount; i++)
+        {
+            if(sortedIds[i] >= count) return false;
+        }
+        return true;
+    }
+
+    // Every index stored on the arrays of the image is in range, so the
+    // queries need no checks. O(V + E), nothing is copied.
+    bool ValidArrays(const char* image, const ImageHeader& header)
+    {
+        const unsigned int* offsets;
+        const unsigned int* sortedIds;
+        offsets = reinterpret_cast<const unsigned int*>(image + header.sectionOffset[VERTEX_NAME_OFFSETS]);
+        sortedIds = reinterpret_cast<const unsigned int*>(image + header.sectionOffset[VERTEX_SORTED_IDS]);
+        if(!ValidNames(offsets, header.vertexCount, sortedIds, header.namedVertexCount,
+                       header.stringBytes))
+            return false;
+
+        offsets = reinterpret_cast<const unsigned int*>(image + header.sectionOffset[EDGE_NAME_OFFSETS]);
+        sortedIds = reinterpret_cast<const unsigned int*>(image + header.sectionOffset[EDGE_NAME_SORTED_IDS]);
+        if(!ValidNames(offsets, header.edgeNameCount, sortedIds, header.edgeNameCount,
+                       header.stringBytes))
+            return false;
+
+        // Edge ranges start at 0, do not overlap and end at the edge count
+        const int* edgeOffsets = reinterpret_cast<const int*>(image + header.sectionOffset[EDGE_OFFSETS]);
+        if(edgeOffsets[0] != 0) return false;
+        for(size_t i = 0; i < header.vertexCount; i++)
+        {
+            if(edgeOffsets[i] > edgeOffsets[i + 1]) return false;
+        }
+        if(edgeOffsets[header.vertexCount] != static_cast<int>(header.edgeCount)) return false;
+
+        const int* targets = reinterpret_cast<const int*>(image + header.sectionOffset[EDGE_TARGETS]);
+        const int* nameIds = reinterpret_cast<const int*>(image + header.sectionOffset[EDGE_NAME_IDS]);
+        for(size_t e = 0; e < header.edgeCount; e++)
+        {
+            if(targets[e] < 0 || targets[e] >= static_cast<int>(header.vertexCount)) return false;
+            if(nameIds[e] < 0 || nameIds[e] >= static_cast<int>(header.edgeNameCount)) return false;
+        }
+        return true;
+    }
+
+    // Sorts the ids by the names they refer to
+    class NameLess
+    {
+        private:
+        const std::vector<std::string>& names;
+
+        public:
+        explicit NameLess(const std::vector<std::string>& n) : names(n) {}
+        bool operator()(unsigned int a, unsigned int b) const
+        {
+            return names[a] < names[b];
+        }
+    };
+
+    // Appends "names" to the string table, fills offsets and sorted ids.
+    // Names marked on "unnamed" (it may be empty) are stored but they are
+    // not on the sorted ids, so they can not be looked up.
+    void WriteNames(unsigned int* offsets, unsigned int* sortedIds,
+                    char* strings, unsigned int& stringEnd,
+                    const std::vector<std::string>& names,
+                    const std::vector<char>& unnamed)
+    {
+        size_t sortedCount = 0;
+        for(size_t i = 0; i < names.size(); i++)
+        {
+            offsets[i] = stringEnd;
+            if(!names[i].empty())
+                std::memcpy(strings + stringEnd, names[i].data(), names[i].size());
+            stringEnd += static_cast<unsigned int>(names[i].size());
+            if(unnamed.empty() || !unnamed[i])
+                sortedIds[sortedCount++] = static_cast<unsigned int>(i);
+        }
+        offsets[names.size()] = stringEnd;
+        std::sort(sortedIds, sortedIds + sortedCount, NameLess(names));
+    }
+}
+
+FrozenGraph::FrozenGraph()
+    : mappedData(NULL)
+    , mappedSize(0)
+{
+    Bind(NULL, 0);
+}
+
+FrozenGraph::FrozenGraph(const MultiGraph& graph)
+    : mappedData(NULL)
+    , mappedSize(0)
+{
+    const std::vector<GraphVertex>& vertexList = graph.vertexList;
+    size_t vCount = vertexList.size();
+    size_t nCount = graph.edgeNameTable.size();
+
+    // Count everything first so that the image is allocated once
+    size_t eCount = 0;
+    size_t stringBytes = 0;
+    std::vector<std::string> vertexNames(vCount);
+    std::vector<char> removed(vCount, 0);
+    for(size_t i = 0; i < vCount; i++)
+    {
+        eCount += vertexList[i].edges.size();
+        vertexNames[i] = vertexList[i].name;
+        removed[i] = vertexList[i].removed;
+        stringBytes += vertexList[i].name.size();
+    }
+    // Tombstones keep their index (and name) but they are not looked up
+    size_t namedCount = vCount - graph.tombstoneCount;
+    for(size_t i = 0; i < nCount; i++)
+        stringBytes += graph.edgeNameTable[i].size();
+
+    size_t sizes[SECTION_COUNT];
+    SectionSizes(sizes, vCount, namedCount, eCount, nCount, stringBytes);
+
+    ImageHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    header.version = IMAGE_VERSION;
+    header.vertexCount = static_cast<unsigned int>(vCount);
+    header.namedVertexCount = static_cast<unsigned int>(namedCount);
+    header.edgeCount = static_cast<unsigned int>(eCount);
+    header.edgeNameCount = static_cast<unsigned int>(nCount);
+    header.stringBytes = static_cast<unsigned int>(stringBytes);
+
+    size_t offset = Align4(sizeof(ImageHeader));
+    for(int s = 0; s < SECTION_COUNT; s++)
+    {
+        header.sectionOffset[s] = offset;
+        offset = Align4(offset + sizes[s]);
+    }
+    header.imageSize = offset;
+
+    storage.assign(offset, 0);
+    char* image = &storage[0];
+    std::memcpy(image, &header, sizeof(header));
+
+    // Strings: vertex names first, then edge names
+    unsigned int stringEnd = 0;
+    char* stringTable = image + header.sectionOffset[STRINGS];
+    WriteNames(reinterpret_cast<unsigned int*>(image + header.sectionOffset[VERTEX_NAME_OFFSETS]),
+               reinterpret_cast<unsigned int*>(image + header.sectionOffset[VERTEX_SORTED_IDS]),
+               stringTable, stringEnd, vertexNames, removed);
+    WriteNames(reinterpret_cast<unsigned int*>(image + header.sectionOffset[EDGE_NAME_OFFSETS]),
+               reinterpret_cast<unsigned int*>(image + header.sectionOffset[EDGE_NAME_SORTED_IDS]),
+               stringTable, stringEnd, graph.edgeNameTable, std::vector<char>());
+
+    // CSR arrays, edges keep the adjacency list order of the graph
+    int*   offsets = reinterpret_cast<int*>(image + header.sectionOffset[EDGE_OFFSETS]);
+    int*   targets = reinterpret_cast<int*>(image + header.sectionOffset[EDGE_TARGETS]);
+    int*   nameIds = reinterpret_cast<int*>(image + header.sectionOffset[EDGE_NAME_IDS]);
+    float* w0 = reinterpret_cast<float*>(image + header.sectionOffset[EDGE_WEIGHT_0]);
+    float* w1 = reinterpret_cast<float*>(image + header.sectionOffset[EDGE_WEIGHT_1]);
+
+    int e = 0;
+    offsets[0] = 0;
+    for(size_t i = 0; i < vCount; i++)
+    {
+        const std::vector<GraphEdge>& edges = vertexList[i].edges;
+        for(size_t j = 0; j < edges.size(); j++, e++)
+        {
+            targets[e] = edges[j].endVertexIndex;
+            nameIds[e] = edges[j].nameId;
+            w0[e] = edges[j].weight[0];
+            w1[e] = edges[j].weight[1];
+        }
+        offsets[i + 1] = e;
+    }
+
+    Bind(image, storage.size());
+}
+
+FrozenGraph::FrozenGraph(const std::string& filePath)
+    : mappedData(NULL)
+    , mappedSize(0)
+{
+    Bind(NULL, 0);
+
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if(fd == -1)
+    {
+        std::cout << "Unable to open " << filePath << std::endl;
+        return;
+    }
+
+    struct stat fileStat;
+    void* data = MAP_FAILED;
+    if(fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+    {
+        data = mmap(NULL, static_cast<size_t>(fileStat.st_size),
+                    PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // Mapping stays valid after the descriptor is closed
+    close(fd);
+
+    if(data == MAP_FAILED)
+    {
+        std::cout << "Unable to map " << filePath << std::endl;
+        return;
+    }
+
+    mappedData = data;
+    mappedSize = static_cast<size_t>(fileStat.st_size);
+    if(!Bind(static_cast<const char*>(mappedData), mappedSize))
+    {
+        std::cout << "Invalid graph file " << filePath << std::endl;
+        Release();
+    }
+}
+
+FrozenGraph::FrozenGraph(const FrozenGraph& other)
+    : mappedData(NULL)
+    , mappedSize(0)
+{
+    Bind(NULL, 0);
+    *this = other;
+}
+
+FrozenGraph& FrozenGraph::operator=(const FrozenGraph& other)
+{
+    if(this == &other) return *this;
+
+    // Copy the image bytes (mapped or owned) into our own storage
+    const char* otherImage = other.mappedData
+                                ? static_cast<const char*>(other.mappedData)
+                                : (other.storage.empty() ? NULL : &other.storage[0]);
+    size_t otherSize = other.mappedData ? other.mappedSize : other.storage.size();
+
+    Release();
+    if(otherImage == NULL) return *this;
+
+    storage.assign(otherImage, otherImage + otherSize);
+    Bind(&storage[0], storage.size());
+    return *this;
+}
+
+FrozenGraph::~FrozenGraph()
+{
+    Release();
+}
+
+void FrozenGraph::Release()
+{
+    if(mappedData) munmap(mappedData, mappedSize);
+    mappedData = NULL;
+    mappedSize = 0;
+    storage.clear();
+    Bind(NULL, 0);
+}
+
+bool FrozenGraph::Bind(const char* image, size_t imageSize)
+{
+    // Empty graph, a single zero offset so that the edge loops still work
+    static const int        EMPTY_OFFSETS[1] = {0};
+    static const unsigned   EMPTY_NAME_OFFSETS[1] = {0};
+
+    vertexCount = 0;
+    namedVertexCount = 0;
+    edgeCount = 0;
+    edgeNameCount = 0;
+    vertexNameOffsets = EMPTY_NAME_OFFSETS;
+    vertexSortedIds = NULL;
+    edgeNameOffsets = EMPTY_NAME_OFFSETS;
+    edgeNameSortedIds = NULL;
+    edgeOffsets = EMPTY_OFFSETS;
+    edgeTargets = NULL;
+    edgeNameIds = NULL;
+    edgeWeight0 = NULL;
+    edgeWeight1 = NULL;
+    strings = NULL;
+
+    if(image == NULL) return true;
+
+    // Validate the header, sections should fit on the image and the
+    // indices on them should be in range
+    ImageHeader header;
+    if(imageSize < sizeof(ImageHeader)) return false;
+    std::memcpy(&header, image, sizeof(header));
+    if(std::memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0) return false;
+    if(header.version != IMAGE_VERSION) return false;
+    if(header.imageSize != imageSize) return false;
+
+    // Counts (and the vertex count + 1 offsets) fit an int
+    const unsigned int MAX_COUNT = std::numeric_limits<int>::max() - 1;
+    if(header.vertexCount > MAX_COUNT || header.edgeCount > MAX_COUNT ||
+       header.edgeNameCount > MAX_COUNT)
+        return false;
+
+    size_t sizes[SECTION_COUNT];
+    if(header.namedVertexCount > header.vertexCount) return false;
+    SectionSizes(sizes, header.vertexCount, header.namedVertexCount,
+                 header.edgeCount, header.edgeNameCount, header.stringBytes);
+    for(int s = 0; s < SECTION_COUNT; s++)
+    {
+        unsigned long long begin = header.sectionOffset[s];
+        if(begin % 4 != 0 || begin > imageSize || sizes[s] > imageSize - begin)
+            return false;
+    }
+    if(!ValidArrays(image, header)) return false;
+
+    vertexCount = static_cast<int>(header.vertexCount);
+    namedVertexCount = static_cast<int>(header.namedVertexCount);
+    edgeCount = static_cast<int>(header.edgeCount);
+    edgeNameCount = static_cast<int>(header.edgeNameCount);
+    vertexNameOffsets = reinterpret_cast<const unsigned int*>(image + header.sectionOffset[VERTEX_NAME_OFFSETS]);
+    vertexSortedIds   = reinterpret_cast<const unsigned int*>(image + header.sectionOffset[VERTEX_SORTED_IDS]);
+    edgeNameOffsets   = reinterpret_cast<const unsigned int*>(image + header.sectionOffset[EDGE_NAME_OFFSETS]);
+    edgeNameSortedIds = reinterpret_cast<const unsigned int*>(image + header.sectionOffset[EDGE_NAME_SORTED_IDS]);
+    edgeOffsets = reinterpret_cast<const int*>(image + header.sectionOffset[EDGE_OFFSETS]);
+    edgeTargets = reinterpret_cast<const int*>(image + header.sectionOffset[EDGE_TARGETS]);
+    edgeNameIds = reinterpret_cast<const int*>(image + header.sectionOffset[EDGE_NAME_IDS]);
+    edgeWeight0 = reinterpret_cast<const float*>(image + header.sectionOffset[EDGE_WEIGHT_0]);
+    edgeWeight1 = reinterpret_cast<const float*>(image + header.sectionOffset[EDGE_WEIGHT_1]);
+    strings = image + header.sectionOffset[STRINGS];
+    return true;
+}
+
+bool FrozenGraph::Save(const std::string& filePath) const
+{
+    const char* image = mappedData
+                            ? static_cast<const char*>(mappedData)
+                            : (storage.empty() ? NULL : &storage[0]);
+    size_t imageSize = mappedData ? mappedSize : storage.size();
+
+    // Empty graph still gets a valid (header only) image
+    if(image == NULL)
+        return FrozenGraph(MultiGraph()).Save(filePath);
+
+    std::ofstream file(filePath.c_str(), std::ios::binary | std::ios::trunc);
+    if(!file.is_open())
+    {
+        std::cout << "Unable to open " << filePath << std::endl;
+        return false;
+    }
+    file.write(image, static_cast<std::streamsize>(imageSize));
+    return static_cast<bool>(file);
+}
+
+bool FrozenGraph::ConvertTextFile(const std::string& textFilePath,
+                                  const std::string& binaryFilePath)
+{
+    // MultiGraph loads an unreadable file as an empty graph, which would
+    // overwrite the output with an empty image
+    std::ifstream textFile(textFilePath.c_str());
+    if(!textFile.is_open())
+    {
+        std::cout << "Unable to open " << textFilePath << std::endl;
+        return false;
+    }
+    textFile.close();
+
+    return MultiGraph(textFilePath).Freeze().Save(binaryFilePath);
+}
+
+float FrozenGraph::Lerp(float w0, float w1, float alpha)
+{
+    return w0 * (1 - alpha) + w1 * alpha;
+}
+
+int FrozenGraph::FindName(const std::string& name,
+                          const unsigned int* nameOffsets,
+                          const unsigned int* sortedIds,
+                          int count, const char* strings)
+{
+    // Binary search on the name-sorted ids, compares the raw bytes
+    // in place (same order as std::string::compare)
+    int low = 0, high = count;
+    while(low < high)
+    {
+        int mid = low + (high - low) / 2;
+        unsigned int id = sortedIds[mid];
+        const char* s = strings + nameOffsets[id];
+        size_t length = nameOffsets[id + 1] - nameOffsets[id];
+
+        size_t common = std::min(length, name.size());
+        int cmp = (common == 0) ? 0 : std::memcmp(s, name.data(), common);
+        if(cmp == 0)
+        {
+            if(length == name.size()) return static_cast<int>(id);
+            cmp = (length < name.size()) ? -1 : 1;
+        }
+
+        if(cmp < 0) low = mid + 1;
+        else high = mid;
+    }
+    return -1;
+}
+
+int FrozenGraph::FindVertexIndex(const std::string& vertexName) const
+{
+    return FindName(vertexName, vertexNameOffsets, vertexSortedIds,
+                    namedVertexCount, strings);
+}
+
+int FrozenGraph::VertexCount() const
+{
+    return vertexCount;
+}
+
+int FrozenGraph::EdgeCount() const
+{
+    return edgeCount;
+}
+
+std::string FrozenGraph::VertexName(int vertexIndex) const
+{
+    unsigned int begin = vertexNameOffsets[vertexIndex];
+    return std::string(strings + begin, vertexNameOffsets[vertexIndex + 1] - begin);
+}
+
+std::string FrozenGraph::EdgeName(int vertexIndex, int localEdgeIndex) const
+{
+    int nameId = edgeNameIds[edgeOffsets[vertexIndex] + localEdgeIndex];
+    unsigned int begin = edgeNameOffsets[nameId];
+    return std::string(strings + begin, edgeNameOffsets[nameId + 1] - begin);
+}
+
+bool FrozenGraph::ShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                               const std::string& vertexNameFrom,
+                               const std::string& vertexNameTo,
+                               float heuristicWeight,
+                               const std::vector<char>& excludedNameIds) const
+{
+    int fromIndex = FindVertexIndex(vertexNameFrom);
+    int toIndex = FindVertexIndex(vertexNameTo);
+
+    if(fromIndex == -1) throw VertexNotFoundException(vertexNameFrom);
+    if(toIndex == -1) throw VertexNotFoundException(vertexNameTo);
+
+    std::vector<float> distance(vertexCount, INF);
+    // Predecessor edge (global CSR edge id) of each vertex
+    std::vector<int> previousEdge(vertexCount, -1);
+    std::vector<int> previous(vertexCount, -1);
+    IndexedDaryHeap<float> pq(vertexCount);
+
+    // Hoist the arrays, inner loop should only touch these
+    const int*   offsets = edgeOffsets;
+    const int*   targets = edgeTargets;
+    const int*   nameIds = edgeNameIds;
+    const float* w0 = edgeWeight0;
+    const float* w1 = edgeWeight1;
+    bool filtered = !excludedNameIds.empty();
+
+    distance[fromIndex] = 0;
+    pq.push(Pair<float, int>{0, fromIndex});
+    while(!pq.empty())
+    {
+        float dist = pq.top().key;
+        int curr = pq.top().value;
+        pq.pop();
+
+        // Point-to-point query, distance of the target is final
+        if(curr == toIndex) break;
+
+        for(int e = offsets[curr]; e < offsets[curr + 1]; e++)
+        {
+            if(filtered && excludedNameIds[nameIds[e]]) continue;
+
+            float newDist = dist + Lerp(w0[e], w1[e], heuristicWeight);
+            int next = targets[e];
+            if(newDist < distance[next])
+            {
+                distance[next] = newDist;
+                previous[next] = curr;
+                previousEdge[next] = e;
+                pq.push(Pair<float, int>{newDist, next});
+            }
+        }
+    }
+
+    if(!(distance[toIndex] < INF)) return false;
+
+    // Walk back the predecessors, (vertex, local edge) pairs are reversed
+    std::vector<int> reversed;
+    for(int curr = toIndex; curr != fromIndex; curr = previous[curr])
+    {
+        reversed.push_back(curr);
+        reversed.push_back(previousEdge[curr] - offsets[previous[curr]]);
+    }
+
+    orderedVertexEdgeIndexList.push_back(fromIndex);
+    for(int i = static_cast<int>(reversed.size()) - 1; i >= 0; i--)
+        orderedVertexEdgeIndexList.push_back(reversed[i]);
+
+    return true;
+}
+
+bool FrozenGraph::HeuristicShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                        const std::string& vertexNameFrom,
+                                        const std::string& vertexNameTo,
+                                        float heuristicWeight) const
+{
+    return ShortestPath(orderedVertexEdgeIndexList,
+                        vertexNameFrom, vertexNameTo,
+                        heuristicWeight, std::vector<char>());
+}
+
+bool FrozenGraph::FilteredShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                       const std::string& vertexNameFrom,
+                                       const std::string& vertexNameTo,
+                                       float heuristicWeight,
+                                       const std::vector<std::string>& edgeNames) const
+{
+    // Resolve the names once, relaxation only checks a flag per edge
+    std::vector<char> excludedNameIds(edgeNameCount, 0);
+    for(size_t i = 0; i < edgeNames.size(); i++)
+    {
+        int nameId = FindName(edgeNames[i], edgeNameOffsets, edgeNameSortedIds,
+                              edgeNameCount, strings);
+        if(nameId != -1) excludedNameIds[nameId] = 1;
+    }
+
+    return ShortestPath(orderedVertexEdgeIndexList,
+                        vertexNameFrom, vertexNameTo,
+                        heuristicWeight, excludedNameIds);
+}
@@ -0,0 +1,105 @@
+#ifndef FROZEN_GRAPH_H
+#define FROZEN_GRAPH_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+class MultiGraph;
+
+// Read-only snapshot of a MultiGraph in compressed sparse row (CSR) form.
+//
+// Edges of the vertex "i" are on the range
+// [edgeOffsets[i], edgeOffsets[i + 1]) of the edge arrays and they are
+// in the same order as the adjacency list of the MultiGraph.
+// So "edgeId - edgeOffsets[i]" is the same local edge index that
+// MultiGraph uses, and the "orderedVertexEdgeIndexList" outputs of both
+// classes are interchangeable (i.e. MultiGraph::PrintPath works on them).
+//
+// Whole snapshot is a single binary image (header, arrays and a string
+// table, see FrozenGraph.cpp for the layout). The image is either built
+// in memory from a MultiGraph or memory mapped from a file written by
+// Save, in the latter case queries run on the mapped pages directly
+// (nothing is parsed or copied on load, the arrays are only validated
+// once so a corrupt file is rejected instead of read out of bounds).
+// Names are resolved by binary
+// search over the name-sorted id arrays of the image.
+//
+// Snapshot does not track its source, it should be rebuilt
+// (MultiGraph::Freeze) after the graph is modified.
+class FrozenGraph
+{
+    private:
+    // Image storage, either owned or mapped
+    std::vector<char>       storage;
+    void*                   mappedData;
+    size_t                  mappedSize;
+    // Views on the image
+    int                     vertexCount;
+    int                     namedVertexCount;   // Without the removed ones
+    int                     edgeCount;
+    int                     edgeNameCount;
+    const unsigned int*     vertexNameOffsets;  // |V| + 1, into "strings"
+    const unsigned int*     vertexSortedIds;    // Vertex ids sorted by name
+    const unsigned int*     edgeNameOffsets;    // |N| + 1, into "strings"
+    const unsigned int*     edgeNameSortedIds;  // Name ids sorted by name
+    const int*              edgeOffsets;        // |V| + 1
+    const int*              edgeTargets;
+    const int*              edgeNameIds;
+    const float*            edgeWeight0;
+    const float*            edgeWeight1;
+    const char*             strings;
+
+    static float Lerp(float w0, float w1, float alpha);
+
+    bool        Bind(const char* image, size_t imageSize);
+    void        Release();
+    static int  FindName(const std::string& name,
+                         const unsigned int* nameOffsets,
+                         const unsigned int* sortedIds,
+                         int count, const char* strings);
+    int         FindVertexIndex(const std::string& vertexName) const;
+    // Dijkstra over the CSR arrays, edges whose name id is marked
+    // on "excludedNameIds" are skipped (it may be empty)
+    bool        ShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                             const std::string& vertexNameFrom,
+                             const std::string& vertexNameTo,
+                             float heuristicWeight,
+                             const std::vector<char>& excludedNameIds) const;
+
+    protected:
+    public:
+    // Constructors & Destructor
+                FrozenGraph();
+    explicit    FrozenGraph(const MultiGraph& graph);
+    // Maps a file written by Save (graph is empty if it can not be loaded)
+    explicit    FrozenGraph(const std::string& filePath);
+                FrozenGraph(const FrozenGraph& other);
+    FrozenGraph& operator=(const FrozenGraph& other);
+                ~FrozenGraph();
+
+    // Binary file
+    bool        Save(const std::string& filePath) const;
+    // False (output untouched) if the text file can not be opened
+    static bool ConvertTextFile(const std::string& textFilePath,
+                                const std::string& binaryFilePath);
+
+    // Accessors
+    int         VertexCount() const;
+    int         EdgeCount() const;
+    std::string VertexName(int vertexIndex) const;
+    std::string EdgeName(int vertexIndex, int localEdgeIndex) const;
+
+    // Shortest Path Functions (same semantics as the MultiGraph versions)
+    bool        HeuristicShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                      const std::string& vertexNameFrom,
+                                      const std::string& vertexNameTo,
+                                      float heuristicWeight) const;
+    bool        FilteredShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                     const std::string& vertexNameFrom,
+                                     const std::string& vertexNameTo,
+                                     float heuristicWeight,
+                                     const std::vector<std::string>& edgeNames) const;
+};
+
+#endif // FROZEN_GRAPH_H
@@ -0,0 +1,200 @@
+#include "GraphBuilder.h"
+#include "Exceptions.h"
+#include <algorithm>
+
+namespace
+{
+    // Sort key of an edge, same named edges between the same vertices
+    // end up next to each other (in insertion order)
+    struct EdgeSortKey
+    {
+        int         from;
+        int         nameId;
+        int         to;
+        int         edge;
+
+        bool operator<(const EdgeSortKey& other) const
+        {
+            if(from != other.from) return from < other.from;
+            if(nameId != other.nameId) return nameId < other.nameId;
+            if(to != other.to) return to < other.to;
+            return edge < other.edge;
+        }
+    };
+}
+
+GraphBuilder::GraphBuilder()
+{}
+
+int GraphBuilder::Intern(std::vector<std::string>& table,
+                         std::unordered_map<std::string, int>& index,
+                         const std::string& name)
+{
+    std::pair<std::unordered_map<std::string, int>::iterator, bool> it;
+    it = index.emplace(name, static_cast<int>(table.size()));
+    if(it.second) table.push_back(name);
+    return it.first->second;
+}
+
+void GraphBuilder::Reserve(int vertexCount, int edgeCount)
+{
+    vertexNames.reserve(vertexCount);
+    endPointNames.reserve(vertexCount);
+    endPointIndex.reserve(vertexCount);
+    edges.reserve(edgeCount);
+}
+
+void GraphBuilder::Clear()
+{
+    vertexNames.clear();
+    endPointNames.clear();
+    endPointIndex.clear();
+    edgeNames.clear();
+    edgeNameIndex.clear();
+    edges.clear();
+}
+
+void GraphBuilder::InsertVertex(const std::string& vertexName)
+{
+    vertexNames.push_back(vertexName);
+}
+
+void GraphBuilder::AddEdge(const std::string& edgeName,
+                           const std::string& vertexFromName,
+                           const std::string& vertexToName,
+                           float weight0, float weight1)
+{
+    PendingEdge edge;
+    edge.nameId = Intern(edgeNames, edgeNameIndex, edgeName);
+    edge.fromNameId = Intern(endPointNames, endPointIndex, vertexFromName);
+    edge.toNameId = Intern(endPointNames, endPointIndex, vertexToName);
+    edge.weight[0] = weight0;
+    edge.weight[1] = weight1;
+    edges.push_back(edge);
+}
+
+int GraphBuilder::VertexCount() const
+{
+    return static_cast<int>(vertexNames.size());
+}
+
+int GraphBuilder::EdgeCount() const
+{
+    return static_cast<int>(edges.size());
+}
+
+MultiGraph GraphBuilder::Build() const
+{
+    MultiGraph graph;
+    std::vector<std::string> messages;
+
+    // Vertices, a duplicate is dropped like a failed InsertVertex
+    graph.vertexIndex.reserve(vertexNames.size());
+    graph.vertexList.reserve(vertexNames.size());
+    for(size_t i = 0; i < vertexNames.size(); i++)
+    {
+        int index = static_cast<int>(graph.vertexList.size());
+        if(!graph.vertexIndex.emplace(vertexNames[i], index).second)
+        {
+            messages.push_back(DuplicateVertexException(vertexNames[i]).ToString());
+            continue;
+        }
+        graph.vertexList.push_back(GraphVertex());
+        graph.vertexList.back().name = vertexNames[i];
+    }
+
+    // End points are resolved once per distinct name, not per edge
+    std::vector<int> endPointVertex(endPointNames.size());
+    for(size_t i = 0; i < endPointNames.size(); i++)
+    {
+        std::unordered_map<std::string, int>::const_iterator it;
+        it = graph.vertexIndex.find(endPointNames[i]);
+        endPointVertex[i] = (it == graph.vertexIndex.end()) ? -1 : it->second;
+    }
+
+    // Edge errors are reported in insertion order
+    std::vector<std::pair<int, std::string> > edgeErrors;
+    std::vector<EdgeSortKey> keys;
+    keys.reserve(edges.size());
+    for(size_t e = 0; e < edges.size(); e++)
+    {
+        const PendingEdge& edge = edges[e];
+        int from = endPointVertex[edge.fromNameId];
+        int to = endPointVertex[edge.toNameId];
+
+        if(from == -1 || to == -1)
+        {
+            const std::string& missing = endPointNames[(from == -1) ? edge.fromNameId
+                                                                    : edge.toNameId];
+            edgeErrors.push_back(std::make_pair(static_cast<int>(e),
+                                                VertexNotFoundException(missing).ToString()));
+            continue;
+        }
+
+        EdgeSortKey key = {from, edge.nameId, to, static_cast<int>(e)};
+        keys.push_back(key);
+    }
+
+    // Sort, then every key equal to its predecessor is a duplicate
+    std::sort(keys.begin(), keys.end());
+    for(size_t k = 1; k < keys.size(); k++)
+    {
+        const EdgeSortKey& prev = keys[k - 1];
+        const EdgeSortKey& curr = keys[k];
+        if(curr.from != prev.from || curr.nameId != prev.nameId || curr.to != prev.to)
+            continue;
+
+        const PendingEdge& edge = edges[curr.edge];
+        SameNamedEdgeException error(edgeNames[edge.nameId],
+                                     endPointNames[edge.fromNameId],
+                                     endPointNames[edge.toNameId]);
+        edgeErrors.push_back(std::make_pair(curr.edge, error.ToString()));
+    }
+
+    std::sort(edgeErrors.begin(), edgeErrors.end());
+    for(size_t i = 0; i < edgeErrors.size(); i++)
+        messages.push_back(edgeErrors[i].second);
+    if(!messages.empty()) throw GraphBuildException(messages);
+
+    // Everything is valid, name ids are already in first use order
+    graph.edgeNameTable = edgeNames;
+    graph.edgeNameIndex = edgeNameIndex;
+
+    std::vector<int> outDegree(graph.vertexList.size(), 0);
+    std::vector<int> inDegree(graph.vertexList.size(), 0);
+    for(size_t k = 0; k < keys.size(); k++)
+    {
+        outDegree[keys[k].from]++;
+        inDegree[keys[k].to]++;
+    }
+    for(size_t i = 0; i < graph.vertexList.size(); i++)
+    {
+        GraphVertex& v = graph.vertexList[i];
+        v.edges.reserve(outDegree[i]);
+        v.edgeIndex.reserve(outDegree[i]);
+        v.inEdges.reserve(inDegree[i]);
+    }
+
+    // Adjacency in insertion order, as AddEdge would have built it
+    for(size_t e = 0; e < edges.size(); e++)
+    {
+        const PendingEdge& edge = edges[e];
+        int from = endPointVertex[edge.fromNameId];
+        int to = endPointVertex[edge.toNameId];
+
+        GraphVertex& v = graph.vertexList[from];
+        GraphEdge graphEdge = {edge.nameId, {edge.weight[0], edge.weight[1]}, to};
+        EdgeKey key = {edge.nameId, to};
+        GraphInEdge inEdge = {from, static_cast<int>(v.edges.size())};
+
+        v.edgeIndex[key] = inEdge.edgeSlot;
+        v.edges.push_back(graphEdge);
+        graph.vertexList[to].inEdges.push_back(inEdge);
+    }
+    return graph;
+}
+
+FrozenGraph GraphBuilder::BuildFrozen() const
+{
+    return FrozenGraph(Build());
+}
@@ -0,0 +1,77 @@
+#ifndef GRAPH_BUILDER_H
+#define GRAPH_BUILDER_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "MultiGraph.h"
+#include "FrozenGraph.h"
+
+// Bulk construction of a MultiGraph (or its frozen form).
+//
+// InsertVertex and AddEdge only record the items, nothing is checked
+// until Build. Build validates everything at once (duplicate vertices,
+// unknown end points and same named edges between the same vertices) and
+// throws a single GraphBuildException with every error found. Edges may
+// be added before their vertices.
+//
+// The built graph is the same as inserting the vertices and then the
+// valid edges one by one (same vertex indices, adjacency order and
+// interned edge name ids), but it costs a sort instead of a lookup per
+// AddEdge.
+//
+// USAGE:
+//
+// GraphBuilder builder;
+// builder.InsertVertex("IST");
+// builder.InsertVertex("ESB");
+// builder.AddEdge("TK2124", "IST", "ESB", 60, 45);
+// MultiGraph graph = builder.Build();
+class GraphBuilder
+{
+    private:
+    struct PendingEdge
+    {
+        int         nameId;
+        int         fromNameId;     // Into "endPointNames"
+        int         toNameId;
+        float       weight[2];
+    };
+
+    // Declared vertices in insertion order
+    std::vector<std::string>    vertexNames;
+    // Every name used as an edge end point, interned
+    std::vector<std::string>    endPointNames;
+    std::unordered_map<std::string, int> endPointIndex;
+    // Interned edge names
+    std::vector<std::string>    edgeNames;
+    std::unordered_map<std::string, int> edgeNameIndex;
+    std::vector<PendingEdge>    edges;
+
+    static int  Intern(std::vector<std::string>& table,
+                       std::unordered_map<std::string, int>& index,
+                       const std::string& name);
+
+    protected:
+    public:
+    // Constructors & Destructor
+                GraphBuilder();
+
+    void        Reserve(int vertexCount, int edgeCount);
+    void        Clear();
+
+    void        InsertVertex(const std::string& vertexName);
+    void        AddEdge(const std::string& edgeName,
+                        const std::string& vertexFromName,
+                        const std::string& vertexToName,
+                        float weight0, float weight1);
+
+    int         VertexCount() const;
+    int         EdgeCount() const;
+
+    // Both throw GraphBuildException if there is any error
+    MultiGraph  Build() const;
+    FrozenGraph BuildFrozen() const;
+};
+
+#endif // GRAPH_BUILDER_H
@@ -0,0 +1,387 @@
+#include "GrowableHashTable.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+GrowableHashTable::GrowableHashTable(int initialCapacity)
+    : migrateIndex(0)
+    , elementCount(0)
+    , usedCount(0)
+{
+    oldTable = Allocate(0);
+    table = Allocate(RoundCapacity(initialCapacity));
+}
+
+GrowableHashTable::GrowableHashTable(const GrowableHashTable& other)
+    : migrateIndex(0)
+    , elementCount(0)
+    , usedCount(0)
+{
+    // Copy is rehashed in a single table (sentinels are dropped)
+    oldTable = Allocate(0);
+    table = Allocate(other.table.capacity);
+    other.ForEach([this](const HashData& data)
+    {
+        new (Claim(data.startInt, data.endInt, data.signature)) HashData(data);
+        elementCount++;
+    });
+}
+
+GrowableHashTable::~GrowableHashTable()
+{
+    Release(oldTable, true);
+    Release(table, true);
+}
+
+GrowableHashTable& GrowableHashTable::operator=(GrowableHashTable other)
+{
+    Swap(other);
+    return *this;
+}
+
+void GrowableHashTable::Swap(GrowableHashTable& other)
+{
+    std::swap(table, other.table);
+    std::swap(oldTable, other.oldTable);
+    std::swap(migrateIndex, other.migrateIndex);
+    std::swap(elementCount, other.elementCount);
+    std::swap(usedCount, other.usedCount);
+}
+
+unsigned int GrowableHashTable::Hash(int startInt, int endInt, const QuerySignature& signature)
+{
+    // Same primes as HashTable, on unsigned arithmetic (wraps instead of
+    // overflowing), high bits are folded since only the low ones are used
+    unsigned int h = 102523u * static_cast<unsigned int>(startInt) +
+                     100907u * static_cast<unsigned int>(endInt) +
+                     104659u * signature.Hash();
+    return h ^ (h >> 16);
+}
+
+int GrowableHashTable::RoundCapacity(int capacity)
+{
+    int result = MIN_CAPACITY;
+    while(result < capacity) result *= 2;
+    return result;
+}
+
+GrowableHashTable::Slots GrowableHashTable::Allocate(int capacity)
+{
+    Slots slots = {NULL, NULL, capacity};
+    if(capacity == 0) return slots;
+
+    // Neither is initialized slot by slot, large blocks are fresh zero
+    // pages so the cost is paid when (and if) a slot is touched
+    slots.data = static_cast<HashData*>(::operator new(sizeof(HashData) * capacity));
+    slots.state = static_cast<unsigned char*>(calloc(capacity, 1));
+    if(!slots.state)
+    {
+        ::operator delete(slots.data);
+        throw std::bad_alloc();
+    }
+    return slots;
+}
+
+void GrowableHashTable::Release(Slots& slots, bool hasEntries)
+{
+    if(slots.capacity == 0) return;
+
+    if(hasEntries)
+    {
+        for(int i = 0; i < slots.capacity; i++)
+        {
+            if(slots.state[i] == SLOT_OCCUPIED) slots.data[i].~HashData();
+        }
+    }
+    ::operator delete(slots.data);
+    free(slots.state);
+    slots = Allocate(0);
+}
+
+int GrowableHashTable::FindSlot(const Slots& slots,
+                                int startInt, int endInt, const QuerySignature& signature)
+{
+    if(slots.capacity == 0) return -1;
+
+    unsigned int mask = static_cast<unsigned int>(slots.capacity) - 1;
+    unsigned int q = Hash(startInt, endInt, signature) & mask;
+    for(unsigned int i = 1; i <= mask + 1 && slots.state[q] != SLOT_EMPTY; i++)
+    {
+        const HashData& data = slots.data[q];
+        if(slots.state[q] == SLOT_OCCUPIED &&
+           data.startInt == startInt && data.endInt == endInt &&
+           data.signature == signature)
+            return static_cast<int>(q);
+        q = (q + i) & mask;
+    }
+    return -1;
+}
+
+int GrowableHashTable::FreeSlot(const Slots& slots,
+                                int startInt, int endInt, const QuerySignature& signature)
+{
+    // Load is kept under the half, there is always a free slot
+    unsigned int mask = static_cast<unsigned int>(slots.capacity) - 1;
+    unsigned int q = Hash(startInt, endInt, signature) & mask;
+    for(unsigned int i = 1; slots.state[q] == SLOT_OCCUPIED; i++)
+        q = (q + i) & mask;
+    return static_cast<int>(q);
+}
+
+void GrowableHashTable::Vacate(Slots& slots, int index)
+{
+    slots.data[index].~HashData();
+    slots.state[index] = SLOT_SENTINEL;
+}
+
+HashData* GrowableHashTable::Lookup(int startInt, int endInt, const QuerySignature& signature)
+{
+    int q = FindSlot(table, startInt, endInt, signature);
+    if(q != -1) return &table.data[q];
+
+    q = FindSlot(oldTable, startInt, endInt, signature);
+    if(q != -1) return &oldTable.data[q];
+    return NULL;
+}
+
+void* GrowableHashTable::Claim(int startInt, int endInt, const QuerySignature& signature)
+{
+    int q = FreeSlot(table, startInt, endInt, signature);
+    if(table.state[q] == SLOT_EMPTY) usedCount++;
+    table.state[q] = SLOT_OCCUPIED;
+    return &table.data[q];
+}
+
+void GrowableHashTable::BeginResize()
+{
+    // Only happens if the resize thresholds are changed
+    if(IsMigrating()) FinishMigration();
+
+    // Grow if the live entries alone would fill a quarter of it,
+    // otherwise it is mostly sentinels and a same sized table purges them
+    int capacity = table.capacity;
+    if((elementCount + 1) * 4 > capacity) capacity *= 2;
+
+    oldTable = table;
+    table = Allocate(capacity);
+    migrateIndex = 0;
+    usedCount = 0;
+}
+
+void GrowableHashTable::MigrateStep(int bucketCount)
+{
+    for(; bucketCount > 0 && migrateIndex < oldTable.capacity; bucketCount--, migrateIndex++)
+    {
+        if(oldTable.state[migrateIndex] != SLOT_OCCUPIED) continue;
+
+        HashData& data = oldTable.data[migrateIndex];
+        new (Claim(data.startInt, data.endInt, data.signature)) HashData(std::move(data));
+        // Moved out, probing of the remaining old entries goes through it
+        Vacate(oldTable, migrateIndex);
+    }
+
+    if(oldTable.capacity != 0 && migrateIndex == oldTable.capacity)
+    {
+        Release(oldTable, false);
+        migrateIndex = 0;
+    }
+}
+
+void GrowableHashTable::FinishMigration()
+{
+    MigrateStep(oldTable.capacity);
+}
+
+int GrowableHashTable::Insert(const std::vector<int>& intArray, const QuerySignature& signature)
+{
+    if(intArray.size() < 1) throw InvalidTableArgException();
+
+    MigrateStep(MIGRATE_STEP);
+
+    int startInt = intArray[0];
+    int endInt = intArray[intArray.size() - 1];
+
+    // Existing key (on either table), same as HashTable
+    HashData* existing = Lookup(startInt, endInt, signature);
+    if(existing)
+    {
+        int result = existing->lruCounter;
+        existing->lruCounter++;
+        return result;
+    }
+
+    if((usedCount + 1) * CAPACITY_THRESHOLD > table.capacity)
+        BeginResize();
+
+    HashData* data = new (Claim(startInt, endInt, signature)) HashData();
+    data->intArray = intArray;
+    data->sentinel = OCCUPIED_MARK;
+    data->signature = signature;
+    data->startInt = startInt;
+    data->endInt = endInt;
+    data->lruCounter = 1;
+    elementCount++;
+    return 0;
+}
+
+bool GrowableHashTable::Find(std::vector<int>& intArray,
+                             int startInt, int endInt, const QuerySignature& signature,
+                             bool incLRU)
+{
+    MigrateStep(MIGRATE_STEP);
+
+    HashData* data = Lookup(startInt, endInt, signature);
+    if(!data) return false;
+
+    if(incLRU) data->lruCounter++;
+    intArray.insert(intArray.end(), data->intArray.begin(), data->intArray.end());
+    return true;
+}
+
+void GrowableHashTable::Remove(std::vector<int>& intArray,
+                               int startInt, int endInt, const QuerySignature& signature)
+{
+    MigrateStep(MIGRATE_STEP);
+
+    int q = FindSlot(table, startInt, endInt, signature);
+    Slots* slots = &table;
+    if(q == -1)
+    {
+        q = FindSlot(oldTable, startInt, endInt, signature);
+        slots = &oldTable;
+    }
+    if(q == -1) return;
+
+    // Sentinel slot keeps counting as used until the next resize
+    const std::vector<int>& removed = slots->data[q].intArray;
+    intArray.insert(intArray.end(), removed.begin(), removed.end());
+    Vacate(*slots, q);
+    elementCount--;
+}
+
+void GrowableHashTable::RemoveLRU(int lruElementCount)
+{
+    // Full scan anyway, entries are all on the new table after this
+    FinishMigration();
+
+    MinPairHeap<int, int> Heap;
+    for(int i = 0; i < table.capacity; i++)
+    {
+        if(table.state[i] == SLOT_OCCUPIED)
+            Heap.push(Pair<int, int> {table.data[i].lruCounter, i});
+    }
+
+    while(lruElementCount > 0 && !Heap.empty())
+    {
+        Vacate(table, Heap.top().value);
+
+        Heap.pop();
+        elementCount--;
+        lruElementCount--;
+    }
+}
+
+void GrowableHashTable::InvalidateTable()
+{
+    Release(oldTable, true);
+    migrateIndex = 0;
+
+    for(int i = 0; i < table.capacity; i++)
+    {
+        if(table.state[i] == SLOT_OCCUPIED) table.data[i].~HashData();
+    }
+    memset(table.state, SLOT_EMPTY, table.capacity);
+    elementCount = 0;
+    usedCount = 0;
+}
+
+void GrowableHashTable::GetMostInserted(std::vector<int>& intArray) const
+{
+    const HashData* most = NULL;
+    ForEach([&most](const HashData& data)
+    {
+        if(!most || data.lruCounter > most->lruCounter) most = &data;
+    });
+
+    intArray.clear();
+    if(most) intArray = most->intArray;
+}
+
+void GrowableHashTable::PrintLine(const HashData& data, int tableIndex) const
+{
+    // Using printf here it is easier to format
+    printf("[%03d] - [%03d] : ", tableIndex, data.lruCounter);
+    printf("(%d/%5.3f/%016llx) ", data.signature.kind,
+           data.signature.Blend(), data.signature.filterHash);
+    size_t sz = data.intArray.size();
+    for(size_t i = 0; i < sz; i++)
+    {
+        if(i % 2 == 0)
+            printf("[%03d]", data.intArray[i]);
+        else
+            printf("/%03d/", data.intArray[i]);
+
+        if(i != sz - 1)
+            printf("-->");
+    }
+    printf("\n");
+}
+
+void GrowableHashTable::PrintSortedLRUEntries() const
+{
+    // Entries may be on either table, indices are the visit order
+    std::vector<const HashData*> entries;
+    ForEach([&entries](const HashData& data) { entries.push_back(&data); });
+
+    MaxPairHeap<int, int> Heap;
+    for(size_t i = 0; i < entries.size(); i++)
+        Heap.push(Pair<int, int> {entries[i]->lruCounter, static_cast<int>(i)});
+
+    while(!Heap.empty())
+    {
+        int i = Heap.top().value;
+        PrintLine(*entries[i], i);
+        Heap.pop();
+    }
+}
+
+void GrowableHashTable::PrintTable() const
+{
+    const Slots* tables[2] = {&oldTable, &table};
+
+    printf("____________________\n");
+    printf("Elements %d (capacity %d%s)\n", elementCount, Capacity(),
+           IsMigrating() ? ", migrating" : "");
+    printf("[IDX] - [LRU] | DATA\n");
+    printf("____________________\n");
+    for(int t = 0; t < 2; t++)
+    {
+        const Slots& slots = *tables[t];
+        for(int i = (t == 0) ? migrateIndex : 0; i < slots.capacity; i++)
+        {
+            if(slots.state[i] == SLOT_SENTINEL)
+                printf("[%03d]         : SENTINEL\n", i);
+            else if(slots.state[i] == SLOT_EMPTY)
+                printf("[%03d]         : EMPTY\n", i);
+            else
+                PrintLine(slots.data[i], i);
+        }
+        if(t == 0 && IsMigrating()) printf("____________________\n");
+    }
+}
+
+int GrowableHashTable::ElementCount() const
+{
+    return elementCount;
+}
+
+int GrowableHashTable::Capacity() const
+{
+    return table.capacity;
+}
+
+bool GrowableHashTable::IsMigrating() const
+{
+    return oldTable.capacity != 0;
+}
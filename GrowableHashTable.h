@@ -0,0 +1,129 @@
+#ifndef GROWABLE_HASH_TABLE_H
+#define GROWABLE_HASH_TABLE_H
+
+#include <vector>
+#include <cstdio>
+#include "HashTable.h"
+
+// Dynamically sized counterpart of HashTable<MAX_SIZE>.
+//
+// Same interface and semantics (Insert returns the previous LRU counter,
+// Find/Remove append the route, RemoveLRU drops the least used entries),
+// but it never throws TableCapFullException.
+//
+// When the used slots (entries and sentinels) of the table pass the half
+// of its capacity a new table is allocated, twice as large (or the same
+// size if it is mostly sentinels), and the old one is migrated a few
+// buckets per operation instead of all at once. Sentinels are not
+// migrated, so the removed entries are purged on every resize. While a
+// migration is running a key is either on the old or on the new table,
+// lookups check both.
+//
+// Slot states are kept on a separate byte array (zeroed pages, empty is
+// 0) and entries are only constructed on occupied slots, so allocating or
+// releasing a table does not touch every slot either.
+//
+// Capacity is a power of two, probing is triangular (h + i(i+1)/2)
+// which visits every slot of such a table.
+class GrowableHashTable
+{
+    private:
+    static const int    MIN_CAPACITY = 16;
+    // Old buckets moved per operation, the old table is always empty
+    // before the new one reaches its threshold (it takes at least
+    // capacity / 4 inserts, this moves 4 * that many buckets)
+    static const int    MIGRATE_STEP = 4;
+
+    enum SlotState
+    {
+        SLOT_EMPTY = 0,
+        SLOT_SENTINEL,
+        SLOT_OCCUPIED
+    };
+
+    struct Slots
+    {
+        HashData*       data;       // Raw storage, constructed if occupied
+        unsigned char*  state;      // SlotState per slot
+        int             capacity;   // Power of two (0 if not allocated)
+    };
+
+    // Properties
+    Slots       table;
+    Slots       oldTable;           // Not allocated if not migrating
+    int         migrateIndex;       // Next bucket of "oldTable"
+    int         elementCount;       // Both tables
+    int         usedCount;          // Occupied or sentinel slots of "table"
+
+    static unsigned int Hash(int startInt, int endInt, const QuerySignature& signature);
+    static int  RoundCapacity(int capacity);
+
+    static Slots Allocate(int capacity);
+    // Entries are destroyed if "hasEntries" (a migrated table has none)
+    static void Release(Slots& slots, bool hasEntries);
+    // Slot of the key (-1 if it is not there)
+    static int  FindSlot(const Slots& slots,
+                         int startInt, int endInt, const QuerySignature& signature);
+    // First sentinel or empty slot of the probe sequence
+    // (the key must not be on the table)
+    static int  FreeSlot(const Slots& slots,
+                         int startInt, int endInt, const QuerySignature& signature);
+    static void Vacate(Slots& slots, int index);
+
+    // Occupied entry of the key on either table (NULL if none)
+    HashData*   Lookup(int startInt, int endInt, const QuerySignature& signature);
+    // Marks a free slot of "table" for the key as occupied and returns
+    // its storage, the caller constructs the entry on it
+    void*       Claim(int startInt, int endInt, const QuerySignature& signature);
+
+    void        BeginResize();
+    void        MigrateStep(int bucketCount);
+    void        FinishMigration();
+    void        PrintLine(const HashData& data, int tableIndex) const;
+
+    protected:
+    public:
+    // Constructors & Destructor
+    explicit    GrowableHashTable(int initialCapacity = MIN_CAPACITY);
+                GrowableHashTable(const GrowableHashTable& other);
+                ~GrowableHashTable();
+    GrowableHashTable& operator=(GrowableHashTable other);
+
+    void        Swap(GrowableHashTable& other);
+
+    // Member Functions
+    int         Insert(const std::vector<int>& intArray, const QuerySignature& signature);
+    bool        Find(std::vector<int>& intArray,
+                     int startInt, int endInt, const QuerySignature& signature,
+                     bool incLRU = false);
+    void        Remove(std::vector<int>& intArray,
+                       int startInt, int endInt, const QuerySignature& signature);
+    void        RemoveLRU(int lruElementCount);
+
+    void        InvalidateTable();
+    // Calls "visit(const HashData&)" for every occupied entry
+    template<class Visitor>
+    void        ForEach(Visitor visit) const;
+    void        GetMostInserted(std::vector<int>& intArray) const;
+    void        PrintSortedLRUEntries() const;
+    void        PrintTable() const;
+
+    int         ElementCount() const;
+    int         Capacity() const;
+    bool        IsMigrating() const;
+};
+
+template<class Visitor>
+void GrowableHashTable::ForEach(Visitor visit) const
+{
+    for(int i = migrateIndex; i < oldTable.capacity; i++)
+    {
+        if(oldTable.state[i] == SLOT_OCCUPIED) visit(oldTable.data[i]);
+    }
+    for(int i = 0; i < table.capacity; i++)
+    {
+        if(table.state[i] == SLOT_OCCUPIED) visit(table.data[i]);
+    }
+}
+
+#endif // GROWABLE_HASH_TABLE_H
@@ -5,6 +5,8 @@
 #include <cstdio>
 #include "IntPair.h"
 #include "Exceptions.h"
+#include "QuerySignature.h"
+#include "PathArena.h"
 
 // Sentinel for probing
 #define SENTINEL_MARK 0xFFFFFFFF
@@ -13,50 +15,236 @@
 // Capacity threshold is the multiplicative inverse of the 1/2 (%50)
 #define CAPACITY_THRESHOLD 2
 
+// Entry of a GrowableHashTable (and the decoded entry visited by
+// HashTable::ForEach)
 struct HashData
 {
     // Data
     std::vector<int> intArray;
     unsigned int     sentinel;
     // Key
-    bool             isCostWeighted;
+    QuerySignature   signature;
     int              startInt;
     int              endInt;
     // LRU Counter (to determine least recently used entry)
     int              lruCounter;
 };
 
-template <int MAX_SIZE>
+// Slot of a HashTable, the route and the rest of its key are on the arena
+struct HashSlot
+{
+    unsigned int    tag;        // Hash of the key, compared first
+    unsigned int    offset;     // Record on the arena
+    unsigned int    length;     // Element count of the route,
+                                // EMPTY_MARK or SENTINEL_MARK if free
+    int             lruCounter;
+
+    bool IsOccupied() const { return length < EMPTY_MARK; }
+};
+
+// Compile time policies of a HashTable, every call is resolved (and
+// usually inlined) at compile time.
+//
+// Key (type of the key, its hash, tag, encoding and comparison)
+//
+// RouteKeyPolicy<Hasher> : RouteKey (start vertex, end vertex and
+//                          QuerySignature), hashed by "Hasher"
+//
+// A key policy has a "Type" and static members:
+//
+// Of(startInt, endInt, signature) : key of a route query
+// Of(intArray, signature)         : key of a route being inserted
+// Hash(key), Tag(key)             : slot hash and the 32 bit tag kept
+//                                   on the slot (independent of Hash)
+// MAX_ENCODED_SIZE, Encode(p, key): key bytes of the arena record
+// EncodedSize(record)
+// Matches(record, route, key)     : "route" follows the key bytes
+// Decode(record, route, data)     : key fields of a HashData
+//
+// Hasher (of a RouteKey)
+//
+// PrimeHash          : sum of the fields times three primes, cheap, for
+//                      prime sizes (modulo keeps every bit)
+// MixHash            : murmur3 finalizer, every key bit affects the low
+//                      bits, for power of two sizes (mask indexing)
+//
+// Probing (offset of the i'th probe from the home slot)
+//
+// QuadraticProbing   : i^2, visits half of the slots of a prime size
+// TriangularProbing  : i(i+1)/2, visits every slot of a power of two size
+// LinearProbing      : i, consecutive slots (fewest cache lines on a
+//                      small table, longer clusters on a large one)
+//
+// Eviction (RemoveLRU, victims are the least used slots first)
+//
+// HeapEviction       : min heap of every occupied slot, O(n log n)
+// SelectEviction     : nth_element then sort of the victims,
+//                      O(n + k log k)
+// ScanEviction       : ranks of the slots on the stack then partial sort,
+//                      no allocation, tables of at most 4096 slots
+struct PrimeHash
+{
+    static unsigned int Hash(const RouteKey& key)
+    {
+        // Unsigned, large keys wrap around instead of overflowing into
+        // negative indices
+        unsigned int cost = key.signature.Hash() % 1024;
+        return 102523u * static_cast<unsigned int>(key.startInt) +
+               100907u * static_cast<unsigned int>(key.endInt) + 104659u * cost;
+    }
+};
+
+struct MixHash
+{
+    static unsigned int Hash(const RouteKey& key)
+    {
+        unsigned long long h = (static_cast<unsigned long long>(static_cast<unsigned int>(key.startInt)) << 32) |
+                               static_cast<unsigned int>(key.endInt);
+        h ^= key.signature.Hash();
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+        return static_cast<unsigned int>(h);
+    }
+};
+
+// Record key is the signature (11 bytes) and the end vertex (varint),
+// the start vertex is not stored twice, it is the first one of the route
+template<class Hasher = PrimeHash>
+struct RouteKeyPolicy
+{
+    typedef RouteKey    Type;
+
+    static const int    SIGNATURE_BYTES = 11;
+    static const int    MAX_ENCODED_SIZE = SIGNATURE_BYTES + PathArena::MAX_VARINT_BYTES;
+
+    static Type         Of(int startInt, int endInt, const QuerySignature& signature);
+    static Type         Of(const std::vector<int>& intArray, const QuerySignature& signature);
+    static unsigned int Hash(const Type& key);
+    static unsigned int Tag(const Type& key);
+
+    static int          Encode(unsigned char* p, const Type& key);
+    static int          EncodedSize(const unsigned char* record);
+    static bool         Matches(const unsigned char* record, const unsigned char* route,
+                                const Type& key);
+    static void         Decode(const unsigned char* record, const unsigned char* route,
+                               HashData& data);
+};
+
+struct QuadraticProbing
+{
+    // 64 bit, i*i overflows an int past 46340
+    static unsigned long long Offset(int i) { return static_cast<unsigned long long>(i) * i; }
+};
+
+struct TriangularProbing
+{
+    static unsigned long long Offset(int i) { return static_cast<unsigned long long>(i) * (i + 1) / 2; }
+};
+
+struct LinearProbing
+{
+    static unsigned long long Offset(int i) { return i; }
+};
+
+// "victims" gets the indices of (at most) "count" occupied slots, least
+// used first
+struct HeapEviction
+{
+    template<int SIZE>
+    static void Victims(std::vector<int>& victims, const HashSlot (&table)[SIZE], int count);
+};
+
+struct SelectEviction
+{
+    template<int SIZE>
+    static void Victims(std::vector<int>& victims, const HashSlot (&table)[SIZE], int count);
+};
+
+struct ScanEviction
+{
+    template<int SIZE>
+    static void Victims(std::vector<int>& victims, const HashSlot (&table)[SIZE], int count);
+};
+
+// Fixed size route table, open addressing.
+//
+// Slots are 16 bytes, routes are encoded on a PathArena. Find either
+// appends the route to a vector or returns a PathView of it (no copy,
+// no allocation). Removed routes are garbage on the arena until an
+// Insert compacts it.
+//
+// Key, probing and eviction are policies (see above), the defaults are
+// the prime size setup. A power of two MAX_SIZE is indexed with a mask
+// instead of a modulo. The (start, end, signature) members build their
+// key with Key::Of, the others take a key of the policy type.
+//
+// USAGE:
+//
+// HashTable<1021> table;                                          // PrimeHash, quadratic, heap
+// HashTable<64, RouteKeyPolicy<MixHash>, LinearProbing, ScanEviction> hot; // 1KB of slots
+// HashTable<1 << 20, RouteKeyPolicy<MixHash>, TriangularProbing, SelectEviction> tail;
+template <int MAX_SIZE, class Key = RouteKeyPolicy<>, class Probing = QuadraticProbing,
+          class Eviction = HeapEviction>
 class HashTable
 {
     private:
-    static int  PRIMES[3];
+    static const bool   IS_POWER_OF_TWO = (MAX_SIZE & (MAX_SIZE - 1)) == 0;
 
     // Properties
-    HashData    table[MAX_SIZE];
+    HashSlot    table[MAX_SIZE];
+    PathArena   arena;
     int         elementCount;
 
     // Private Members
-    static int  Hash(int startInt, int endInt, bool isCostWeighted);
+    // Slot of the probe offset "offset" from hash "h"
+    static int  Index(unsigned long long h, unsigned long long offset);
+    // Occupied slot of the key (-1 if none)
+    int         FindSlot(const typename Key::Type& key) const;
+    // Route of the record of a slot (after its key)
+    const unsigned char* Route(int tableIndex) const;
+    size_t      RecordSize(int tableIndex) const;
+    // Moves the live records to a new arena
+    void        CompactArena();
+    void        Vacate(int tableIndex);
     // Implemented Private Members
     void        PrintLine(int tableIndex) const;
 
     public:
+    typedef typename Key::Type  KeyType;
+
     // Constructors & Destructor
                 HashTable();
     // Member Functions
-    int         Insert(const std::vector<int>& intArray, bool isCostWeighted);
+    int         Insert(const std::vector<int>& intArray, const QuerySignature& signature);
+    int         Insert(const std::vector<int>& intArray, const KeyType& key);
     bool        Find(std::vector<int>& intArray,
-                     int startInt, int endInt, bool isCostWeighted,
+                     int startInt, int endInt, const QuerySignature& signature,
                      bool incLRU = false);
+    bool        Find(std::vector<int>& intArray, const KeyType& key, bool incLRU = false);
+    // Zero copy, "view" is valid until the table is modified
+    bool        Find(PathView& view,
+                     int startInt, int endInt, const QuerySignature& signature,
+                     bool incLRU = false);
+    bool        Find(PathView& view, const KeyType& key, bool incLRU = false);
     void        Remove(std::vector<int>& intArray,
-                       int startInt, int endInt, bool isCostWeighted);
+                       int startInt, int endInt, const QuerySignature& signature);
+    void        Remove(std::vector<int>& intArray, const KeyType& key);
     void        RemoveLRU(int lruElementCount);
 
     void        InvalidateTable();
+    // Calls "visit(const HashData&)" for every occupied entry
+    // (decoded to a temporary)
+    template<class Visitor>
+    void        ForEach(Visitor visit) const;
     void        GetMostInserted(std::vector<int>& intArray) const;
     void        PrintSortedLRUEntries() const;
     void        PrintTable() const;
+
+    // Slots and arena in bytes
+    size_t      MemoryUsage() const;
 };
 
 // Template Implementation
@@ -1,27 +1,33 @@
 #ifndef HASH_TABLE_HPP
 #define HASH_TABLE_HPP
 
-template<int MAX_SIZE>
-int HashTable<MAX_SIZE>::PRIMES[3] = {102523, 100907, 104659};
+#include <algorithm>
+#include <cstring>
 
-template<int MAX_SIZE>
-void HashTable<MAX_SIZE>::PrintLine(int tableIndex) const
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+void HashTable<MAX_SIZE, Key, Probing, Eviction>::PrintLine(int tableIndex) const
 {
-    const HashData& data = table[tableIndex];
+    const HashSlot& slot = table[tableIndex];
 
     // Using printf here it is easier to format
-    if(data.sentinel == SENTINEL_MARK)
+    if(slot.length == SENTINEL_MARK)
     {
         printf("[%03d]         : SENTINEL\n", tableIndex);
     }
-    else if(data.sentinel == EMPTY_MARK)
+    else if(slot.length == EMPTY_MARK)
     {
         printf("[%03d]         : EMPTY\n", tableIndex);
     }
     else
     {
-        printf("[%03d] - [%03d] : ", tableIndex, data.lruCounter);
-        printf("(%-5s) ", data.isCostWeighted ? "True" : "False");
+        HashData data;
+        const unsigned char* route = Route(tableIndex);
+        Key::Decode(arena.Record(slot.offset), route, data);
+        PathArena::View(route, slot.length).AppendTo(data.intArray);
+
+        printf("[%03d] - [%03d] : ", tableIndex, slot.lruCounter);
+        printf("(%d/%5.3f/%016llx) ", data.signature.kind,
+               data.signature.Blend(), data.signature.filterHash);
         size_t sz = data.intArray.size();
         for(size_t i = 0; i < sz; i++)
         {
@@ -37,8 +43,8 @@ void HashTable<MAX_SIZE>::PrintLine(int tableIndex) const
     }
 }
 
-template<int MAX_SIZE>
-void HashTable<MAX_SIZE>::PrintTable() const
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+void HashTable<MAX_SIZE, Key, Probing, Eviction>::PrintTable() const
 {
     printf("____________________\n");
     printf("Elements %d\n", elementCount);
@@ -50,94 +56,196 @@ void HashTable<MAX_SIZE>::PrintTable() const
     }
 }
 
-template<int MAX_SIZE>
-int HashTable<MAX_SIZE>::Hash(int startInt, int endInt, bool isCostWeighted)
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+int HashTable<MAX_SIZE, Key, Probing, Eviction>::Index(unsigned long long h, unsigned long long offset)
 {
-    int cost;
-    
-    if(isCostWeighted) cost=1;
-    else cost=0;
-    
-    return PRIMES[0]*startInt+PRIMES[1]*endInt+PRIMES[2]*cost;
+    // Resolved at compile time, a power of two size is a mask
+    if constexpr(IS_POWER_OF_TWO)
+        return static_cast<int>((h + offset) & (MAX_SIZE - 1));
+    else
+        return static_cast<int>((h + offset) % MAX_SIZE);
 }
 
-template<int MAX_SIZE>
-HashTable<MAX_SIZE>::HashTable()
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+const unsigned char* HashTable<MAX_SIZE, Key, Probing, Eviction>::Route(int tableIndex) const
+{
+    const unsigned char* record = arena.Record(table[tableIndex].offset);
+    return record + Key::EncodedSize(record);
+}
+
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+size_t HashTable<MAX_SIZE, Key, Probing, Eviction>::RecordSize(int tableIndex) const
+{
+    const unsigned char* route = Route(tableIndex);
+    return (route - arena.Record(table[tableIndex].offset)) + PathArena::RouteSize(route, table[tableIndex].length);
+}
+
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+HashTable<MAX_SIZE, Key, Probing, Eviction>::HashTable()
 {
     elementCount = 0;
     
     for(int i=0;i<MAX_SIZE;i++){
         table[i].lruCounter = 0;
-        table[i].sentinel = EMPTY_MARK;
+        table[i].length = EMPTY_MARK;
+    }
+}
+
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+int HashTable<MAX_SIZE, Key, Probing, Eviction>::FindSlot(const typename Key::Type& key) const
+{
+    unsigned long long h = Index(Key::Hash(key), 0);
+    unsigned int tag = Key::Tag(key);
+    
+    for(int q = h, i=0; table[q].length != EMPTY_MARK && i < MAX_SIZE; ++i ,q = Index(h, Probing::Offset(i))){
+        if(table[q].length == SENTINEL_MARK || table[q].tag != tag) continue;
+        if(Key::Matches(arena.Record(table[q].offset), Route(q), key)) return q;
     }
+    
+    return -1;
+}
+
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+void HashTable<MAX_SIZE, Key, Probing, Eviction>::CompactArena()
+{
+    PathArena compacted;
+    for(int i = 0; i < MAX_SIZE; i++){
+        if(table[i].length == EMPTY_MARK || table[i].length == SENTINEL_MARK) continue;
+        table[i].offset = compacted.Append(arena, table[i].offset, RecordSize(i));
+    }
+    arena.Swap(compacted);
+}
+
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+void HashTable<MAX_SIZE, Key, Probing, Eviction>::Vacate(int tableIndex)
+{
+    arena.Release(RecordSize(tableIndex));
+    table[tableIndex].length = SENTINEL_MARK;
+}
+
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+int HashTable<MAX_SIZE, Key, Probing, Eviction>::Insert(const std::vector<int>& intArray, const QuerySignature& signature)
+{
+    if(intArray.size()<1) throw InvalidTableArgException();
+    
+    return Insert(intArray, Key::Of(intArray, signature));
 }
 
-template<int MAX_SIZE>
-int HashTable<MAX_SIZE>::Insert(const std::vector<int>& intArray, bool isCostWeighted)
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+int HashTable<MAX_SIZE, Key, Probing, Eviction>::Insert(const std::vector<int>& intArray, const KeyType& key)
 {
     if(intArray.size()<1) throw InvalidTableArgException();
     
-    int result=0, h = Hash(intArray[0], intArray[intArray.size()-1], isCostWeighted) % MAX_SIZE, q, i;
+    int result=0, q, i, freeSlot=-1;
+    unsigned long long h = Index(Key::Hash(key), 0);
+    unsigned int tag = Key::Tag(key);
     
-    for(q = h, i=0; table[q].sentinel == OCCUPIED_MARK; ++i ,q = (h + i*i) % MAX_SIZE){
-        if(table[q].startInt == intArray[0] && table[q].endInt == intArray[intArray.size()-1] && table[q].isCostWeighted == isCostWeighted){
+    // The key may be after a removed (sentinel) entry,
+    // probe until an empty slot and reuse the first sentinel
+    for(q = h, i=0; table[q].length != EMPTY_MARK && i < MAX_SIZE; ++i ,q = Index(h, Probing::Offset(i))){
+        if(table[q].length == SENTINEL_MARK){
+            if(freeSlot == -1) freeSlot = q;
+            continue;
+        }
+        if(table[q].tag == tag && Key::Matches(arena.Record(table[q].offset), Route(q), key)){
             result=table[q].lruCounter;
             table[q].lruCounter++;
             return result;
         }
     }
+    if(freeSlot != -1) q = freeSlot;
     
-    if(elementCount > MAX_SIZE/2) throw TableCapFullException(elementCount);
+    if(elementCount > MAX_SIZE/2 || (table[q].length != EMPTY_MARK && table[q].length != SENTINEL_MARK)) throw TableCapFullException(elementCount);
     
-    elementCount++;
-    table[q].startInt = intArray[0];
-    table[q].endInt = intArray[intArray.size()-1];
-    table[q].lruCounter++;
+    // Offsets change, slots do not
+    if(arena.NeedsCompaction()) CompactArena();
     
-    for(i=0;i<intArray.size();i++) table[q].intArray.push_back(intArray[i]);
+    unsigned char encoded[Key::MAX_ENCODED_SIZE];
+    int encodedSize = Key::Encode(encoded, key);
     
-    table[q].isCostWeighted = isCostWeighted;
-    table[q].sentinel = OCCUPIED_MARK;
+    elementCount++;
+    table[q].tag = tag;
+    table[q].offset = arena.Append(encoded, encodedSize, intArray);
+    table[q].length = intArray.size();
+    table[q].lruCounter = 1;
     
     return result;
 }
 
-template<int MAX_SIZE>
-bool HashTable<MAX_SIZE>::Find(std::vector<int>& intArray,
-                               int startInt, int endInt, bool isCostWeighted,
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+bool HashTable<MAX_SIZE, Key, Probing, Eviction>::Find(std::vector<int>& intArray,
+                               int startInt, int endInt, const QuerySignature& signature,
                                bool incLRU)
 {
-    int h = Hash(startInt, endInt, isCostWeighted) % MAX_SIZE;
+    return Find(intArray, Key::Of(startInt, endInt, signature), incLRU);
+}
+
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+bool HashTable<MAX_SIZE, Key, Probing, Eviction>::Find(std::vector<int>& intArray, const KeyType& key, bool incLRU)
+{
+    PathView view;
+    if(!Find(view, key, incLRU)) return false;
     
-    for(int q = h, i=0; table[q].sentinel != EMPTY_MARK; ++i ,q = (h + i*i) % MAX_SIZE){
-        if(table[q].startInt == startInt && table[q].endInt == endInt && table[q].isCostWeighted == isCostWeighted && table[q].sentinel != SENTINEL_MARK){
-            if(incLRU) table[q].lruCounter++;
-            for(int j = 0; j < table[q].intArray.size(); j++) intArray.push_back(table[q].intArray[j]);
-            return true;
-        }
-    }
+    view.AppendTo(intArray);
+    return true;
+}
+
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+bool HashTable<MAX_SIZE, Key, Probing, Eviction>::Find(PathView& view,
+                               int startInt, int endInt, const QuerySignature& signature,
+                               bool incLRU)
+{
+    return Find(view, Key::Of(startInt, endInt, signature), incLRU);
+}
+
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+bool HashTable<MAX_SIZE, Key, Probing, Eviction>::Find(PathView& view, const KeyType& key, bool incLRU)
+{
+    int q = FindSlot(key);
+    if(q == -1) return false;
     
-    return false;
+    if(incLRU) table[q].lruCounter++;
+    view = PathArena::View(Route(q), table[q].length);
+    return true;
 }
 
-template<int MAX_SIZE>
-void HashTable<MAX_SIZE>::InvalidateTable()
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+void HashTable<MAX_SIZE, Key, Probing, Eviction>::InvalidateTable()
 {
     for(int i = 0; i < MAX_SIZE; i++){
-        table[i].sentinel = EMPTY_MARK;
+        table[i].length = EMPTY_MARK;
         table[i].lruCounter = 0;
     }
     
+    arena.Clear();
     elementCount = 0;
 }
 
-template<int MAX_SIZE>
-void HashTable<MAX_SIZE>::GetMostInserted(std::vector<int>& intArray) const
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+template<class Visitor>
+void HashTable<MAX_SIZE, Key, Probing, Eviction>::ForEach(Visitor visit) const
 {
-    int theIndex, maxCount=0, i;
+    HashData data;
+    data.sentinel = OCCUPIED_MARK;
+    for(int i = 0; i < MAX_SIZE; i++){
+        if(table[i].length == EMPTY_MARK || table[i].length == SENTINEL_MARK) continue;
+        
+        const unsigned char* route = Route(i);
+        Key::Decode(arena.Record(table[i].offset), route, data);
+        data.intArray.clear();
+        PathArena::View(route, table[i].length).AppendTo(data.intArray);
+        data.lruCounter = table[i].lruCounter;
+        visit(data);
+    }
+}
+
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+void HashTable<MAX_SIZE, Key, Probing, Eviction>::GetMostInserted(std::vector<int>& intArray) const
+{
+    int theIndex=-1, maxCount=0, i;
     
     for(i = 0; i < MAX_SIZE; i++){
-        if(table[i].sentinel != OCCUPIED_MARK) continue;
+        if(table[i].length == EMPTY_MARK || table[i].length == SENTINEL_MARK) continue;
         
         if(table[i].lruCounter > maxCount){
             maxCount = table[i].lruCounter;
@@ -146,69 +254,200 @@ void HashTable<MAX_SIZE>::GetMostInserted(std::vector<int>& intArray) const
     }
     
     intArray.clear();
-    for(i=0;i<table[theIndex].intArray.size();i++) intArray.push_back(table[theIndex].intArray[i]);
+    if(theIndex != -1) PathArena::View(Route(theIndex), table[theIndex].length).AppendTo(intArray);
+}
+
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+void HashTable<MAX_SIZE, Key, Probing, Eviction>::Remove(std::vector<int>& intArray,
+                                 int startInt, int endInt, const QuerySignature& signature)
+{
+    Remove(intArray, Key::Of(startInt, endInt, signature));
 }
 
-template<int MAX_SIZE>
-void HashTable<MAX_SIZE>::Remove(std::vector<int>& intArray,
-                                 int startInt, int endInt, bool isCostWeighted)
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+void HashTable<MAX_SIZE, Key, Probing, Eviction>::Remove(std::vector<int>& intArray, const KeyType& key)
 {
-    int h = Hash(startInt, endInt, isCostWeighted) % MAX_SIZE;
+    int q = FindSlot(key);
+    if(q == -1) return;
     
-    for(int q = h, i=0; table[q].sentinel != EMPTY_MARK; ++i ,q = (h + i*i) % MAX_SIZE){
-        if(table[q].sentinel == SENTINEL_MARK) continue;
-        
-        if(table[q].startInt == startInt && table[q].endInt == endInt && table[q].isCostWeighted == isCostWeighted){
-            table[q].sentinel = SENTINEL_MARK;
-            for(int j = 0; j < table[q].intArray.size(); j++) intArray.push_back(table[q].intArray[j]);
-            elementCount--;
-            return;
-        }
+    PathArena::View(Route(q), table[q].length).AppendTo(intArray);
+    Vacate(q);
+    elementCount--;
+}
+
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+void HashTable<MAX_SIZE, Key, Probing, Eviction>::RemoveLRU(int lruElementCount)
+{
+    std::vector<int> victims;
+    Eviction::Victims(victims, table, lruElementCount);
+    
+    for(size_t i = 0; i < victims.size(); i++){
+        Vacate(victims[i]);
+        elementCount--;
     }
 }
 
-template<int MAX_SIZE>
-void HashTable<MAX_SIZE>::RemoveLRU(int lruElementCount)
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+void HashTable<MAX_SIZE, Key, Probing, Eviction>::PrintSortedLRUEntries() const
 {
     int i;
-    MinPairHeap<int, int> Heap;
+    MaxPairHeap<int, int> Heap;
     
     for(i=0;i<MAX_SIZE;i++){
-        if(table[i].sentinel == OCCUPIED_MARK){
+        if(table[i].length != EMPTY_MARK && table[i].length != SENTINEL_MARK){
             Heap.push(Pair<int, int> {table[i].lruCounter, i});
         }
     }
     
-    while(lruElementCount){
+    while(!Heap.empty()){
         i=Heap.top().value;
         
-        table[i].sentinel = SENTINEL_MARK;
+        PrintLine(i);
         
         Heap.pop();
-        elementCount--;
-        lruElementCount--;
     }
 }
 
-template<int MAX_SIZE>
-void HashTable<MAX_SIZE>::PrintSortedLRUEntries() const
+template<int MAX_SIZE, class Key, class Probing, class Eviction>
+size_t HashTable<MAX_SIZE, Key, Probing, Eviction>::MemoryUsage() const
+{
+    return sizeof(table) + arena.MemoryUsage();
+}
+
+template<class Hasher>
+RouteKey RouteKeyPolicy<Hasher>::Of(int startInt, int endInt, const QuerySignature& signature)
+{
+    RouteKey key = {startInt, endInt, signature};
+    return key;
+}
+
+template<class Hasher>
+RouteKey RouteKeyPolicy<Hasher>::Of(const std::vector<int>& intArray, const QuerySignature& signature)
+{
+    return Of(intArray[0], intArray[intArray.size() - 1], signature);
+}
+
+template<class Hasher>
+unsigned int RouteKeyPolicy<Hasher>::Hash(const RouteKey& key)
+{
+    return Hasher::Hash(key);
+}
+
+template<class Hasher>
+unsigned int RouteKeyPolicy<Hasher>::Tag(const RouteKey& key)
+{
+    // Independent of the hash, keys probing the same slots rarely
+    // share it
+    unsigned int h = static_cast<unsigned int>(key.startInt) * 0x9E3779B1u;
+    h = (h ^ static_cast<unsigned int>(key.endInt)) * 0x85EBCA77u;
+    h = (h ^ key.signature.Hash()) * 0xC2B2AE3Du;
+    return h ^ (h >> 16);
+}
+
+template<class Hasher>
+int RouteKeyPolicy<Hasher>::Encode(unsigned char* p, const RouteKey& key)
+{
+    memcpy(p, &key.signature.filterHash, 8);
+    memcpy(p + 8, &key.signature.blend, 2);
+    p[10] = key.signature.kind;
+    return PathArena::PutVarint(p + SIGNATURE_BYTES, static_cast<unsigned int>(key.endInt)) - p;
+}
+
+template<class Hasher>
+int RouteKeyPolicy<Hasher>::EncodedSize(const unsigned char* record)
+{
+    const unsigned char* p = record + SIGNATURE_BYTES;
+    PathArena::GetVarint(p);
+    return p - record;
+}
+
+template<class Hasher>
+bool RouteKeyPolicy<Hasher>::Matches(const unsigned char* record, const unsigned char* route,
+                                   const RouteKey& key)
+{
+    unsigned long long filterHash;
+    unsigned short blend;
+    memcpy(&filterHash, record, 8);
+    memcpy(&blend, record + 8, 2);
+    if(filterHash != key.signature.filterHash || blend != key.signature.blend ||
+       record[10] != key.signature.kind)
+        return false;
+
+    const unsigned char* p = record + SIGNATURE_BYTES;
+    if(static_cast<int>(PathArena::GetVarint(p)) != key.endInt) return false;
+    // First vertex of the route, delta from 0
+    return PathArena::UnZigZag(PathArena::GetVarint(route)) == key.startInt;
+}
+
+template<class Hasher>
+void RouteKeyPolicy<Hasher>::Decode(const unsigned char* record, const unsigned char* route,
+                                  HashData& data)
+{
+    memcpy(&data.signature.filterHash, record, 8);
+    memcpy(&data.signature.blend, record + 8, 2);
+    data.signature.kind = record[10];
+
+    const unsigned char* p = record + SIGNATURE_BYTES;
+    data.endInt = static_cast<int>(PathArena::GetVarint(p));
+    data.startInt = PathArena::UnZigZag(PathArena::GetVarint(route));
+}
+
+template<int SIZE>
+void HeapEviction::Victims(std::vector<int>& victims, const HashSlot (&table)[SIZE], int count)
 {
     int i;
-    MaxPairHeap<int, int> Heap;
+    MinPairHeap<int, int> Heap;
     
-    for(i=0;i<MAX_SIZE;i++){
-        if(table[i].sentinel == OCCUPIED_MARK){
+    for(i=0;i<SIZE;i++){
+        if(table[i].IsOccupied()){
             Heap.push(Pair<int, int> {table[i].lruCounter, i});
         }
     }
     
-    while(!Heap.empty()){
-        i=Heap.top().value;
-        
-        PrintLine(i);
-        
+    while(count > 0 && !Heap.empty()){
+        victims.push_back(Heap.top().value);
         Heap.pop();
+        count--;
+    }
+}
+
+template<int SIZE>
+void SelectEviction::Victims(std::vector<int>& victims, const HashSlot (&table)[SIZE], int count)
+{
+    std::vector<Pair<int, int> > slots;
+    for(int i = 0; i < SIZE; i++){
+        if(table[i].IsOccupied()) slots.push_back(Pair<int, int> {table[i].lruCounter, i});
+    }
+    if(count <= 0 || slots.empty()) return;
+    
+    // Only the victims are sorted
+    LessComparator<Pair<int, int> > less;
+    size_t k = std::min(static_cast<size_t>(count), slots.size());
+    std::nth_element(slots.begin(), slots.begin() + (k - 1), slots.end(), less);
+    std::sort(slots.begin(), slots.begin() + k, less);
+    
+    for(size_t i = 0; i < k; i++) victims.push_back(slots[i].value);
+}
+
+template<int SIZE>
+void ScanEviction::Victims(std::vector<int>& victims, const HashSlot (&table)[SIZE], int count)
+{
+    static_assert(SIZE <= 4096, "ScanEviction keeps a rank per slot on the stack");
+    
+    // Slots are ranked by (counter, index) packed in 64 bits, counters
+    // are biased to keep their order
+    unsigned long long ranks[SIZE];
+    int n = 0;
+    for(int i = 0; i < SIZE; i++){
+        if(table[i].IsOccupied())
+            ranks[n++] = static_cast<unsigned long long>(static_cast<unsigned int>(table[i].lruCounter) ^ 0x80000000u) << 32 | i;
     }
+    
+    int k = std::min(count, n);
+    if(k <= 0) return;
+    
+    std::partial_sort(ranks, ranks + k, ranks + n);
+    for(int i = 0; i < k; i++) victims.push_back(static_cast<int>(ranks[i] & 0xFFFFFFFF));
 }
 
 #endif // HASH_TABLE_HPP
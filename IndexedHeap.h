@@ -0,0 +1,278 @@
+#ifndef INDEXED_HEAP_H
+#define INDEXED_HEAP_H
+
+#include <vector>
+#include <cstring>
+#include "IntPair.h"
+
+// Priority queues for the graph searches. Both of them hold Pair<K, int>
+// where the value is a vertex index and keep the std::priority_queue
+// member names (push, top, pop, empty, size), so they can replace
+// MinPairHeap in the search loops.
+
+// Indexed D-ary min heap with a position map (vertex -> heap slot).
+//
+// A vertex is in the heap at most once, pushing a vertex that is already
+// in the heap updates its key (both directions). So there is no
+// duplicated entry, heap size is bounded by |V| and there is nothing
+// stale to skip on pop.
+//
+// USAGE:
+//
+// IndexedDaryHeap<float> pq(vertexCount);  // 4-ary
+// pq.push(Pair<float, int>{0, source});
+template<class K, int D = 4>
+class IndexedDaryHeap
+{
+    private:
+    std::vector<Pair<K, int> >  heap;
+    std::vector<int>            position;   // -1 if not in the heap
+
+    void        SiftUp(int i);
+    void        SiftDown(int i);
+    void        Place(int i, const Pair<K, int>& item);
+
+    public:
+    explicit    IndexedDaryHeap(int capacity = 0);
+
+    // Clears the heap and resizes the position map
+    void                    reset(int capacity);
+    bool                    empty() const;
+    int                     size() const;
+    bool                    contains(int value) const;
+    const Pair<K, int>&     top() const;
+    void                    push(const Pair<K, int>& item);
+    void                    pop();
+};
+
+// Monotone radix heap for non-negative float keys.
+//
+// Popped keys never decrease (Dijkstra property). Non-negative IEEE floats
+// have the same order as their bit patterns, so an item is placed into
+// the bucket of the highest bit where its key differs from the last
+// popped key. Each item moves to a lower bucket at most 32 times, push is
+// O(1) and pop is amortized O(log C).
+//
+// It is not indexed; stale entries are popped like on MinPairHeap.
+class RadixHeap
+{
+    private:
+    std::vector<Pair<float, int> >  buckets[33];
+    unsigned int                    last;
+    int                             count;
+
+    static unsigned int Bits(float key);
+    int         Bucket(float key) const;
+    void        Refill();
+
+    public:
+                RadixHeap();
+
+    void                    reset();
+    bool                    empty() const;
+    int                     size() const;
+    const Pair<float, int>& top();
+    void                    push(const Pair<float, int>& item);
+    void                    pop();
+};
+
+//=======================//
+// INDEXED D-ARY HEAP    //
+//=======================//
+template<class K, int D>
+IndexedDaryHeap<K, D>::IndexedDaryHeap(int capacity)
+    : position(capacity, -1)
+{}
+
+template<class K, int D>
+void IndexedDaryHeap<K, D>::reset(int capacity)
+{
+    // Only the vertices still in the heap have a position
+    for(size_t i = 0; i < heap.size(); i++)
+        position[heap[i].value] = -1;
+    heap.clear();
+    position.resize(capacity, -1);
+}
+
+template<class K, int D>
+bool IndexedDaryHeap<K, D>::empty() const
+{
+    return heap.empty();
+}
+
+template<class K, int D>
+int IndexedDaryHeap<K, D>::size() const
+{
+    return static_cast<int>(heap.size());
+}
+
+template<class K, int D>
+bool IndexedDaryHeap<K, D>::contains(int value) const
+{
+    return position[value] != -1;
+}
+
+template<class K, int D>
+const Pair<K, int>& IndexedDaryHeap<K, D>::top() const
+{
+    return heap[0];
+}
+
+template<class K, int D>
+void IndexedDaryHeap<K, D>::Place(int i, const Pair<K, int>& item)
+{
+    heap[i] = item;
+    position[item.value] = i;
+}
+
+template<class K, int D>
+void IndexedDaryHeap<K, D>::SiftUp(int i)
+{
+    Pair<K, int> item = heap[i];
+    while(i > 0)
+    {
+        int parent = (i - 1) / D;
+        if(!(item.key < heap[parent].key)) break;
+        Place(i, heap[parent]);
+        i = parent;
+    }
+    Place(i, item);
+}
+
+template<class K, int D>
+void IndexedDaryHeap<K, D>::SiftDown(int i)
+{
+    Pair<K, int> item = heap[i];
+    int count = static_cast<int>(heap.size());
+    while(true)
+    {
+        int first = i * D + 1;
+        if(first >= count) break;
+
+        // Smallest child
+        int last = (first + D < count) ? first + D : count;
+        int child = first;
+        for(int c = first + 1; c < last; c++)
+        {
+            if(heap[c].key < heap[child].key) child = c;
+        }
+
+        if(!(heap[child].key < item.key)) break;
+        Place(i, heap[child]);
+        i = child;
+    }
+    Place(i, item);
+}
+
+template<class K, int D>
+void IndexedDaryHeap<K, D>::push(const Pair<K, int>& item)
+{
+    int i = position[item.value];
+    if(i == -1)
+    {
+        heap.push_back(item);
+        SiftUp(static_cast<int>(heap.size()) - 1);
+        return;
+    }
+
+    // Already in the heap, update the key
+    K old = heap[i].key;
+    heap[i].key = item.key;
+    if(item.key < old) SiftUp(i);
+    else SiftDown(i);
+}
+
+template<class K, int D>
+void IndexedDaryHeap<K, D>::pop()
+{
+    position[heap[0].value] = -1;
+    Pair<K, int> back = heap.back();
+    heap.pop_back();
+    if(heap.empty()) return;
+
+    heap[0] = back;
+    SiftDown(0);
+}
+
+//=======================//
+// RADIX HEAP            //
+//=======================//
+inline RadixHeap::RadixHeap()
+    : last(0)
+    , count(0)
+{}
+
+inline unsigned int RadixHeap::Bits(float key)
+{
+    unsigned int bits;
+    std::memcpy(&bits, &key, sizeof(bits));
+    return bits;
+}
+
+inline int RadixHeap::Bucket(float key) const
+{
+    unsigned int diff = Bits(key) ^ last;
+    if(diff == 0) return 0;
+    return 32 - __builtin_clz(diff);
+}
+
+inline void RadixHeap::reset()
+{
+    for(int b = 0; b < 33; b++) buckets[b].clear();
+    last = 0;
+    count = 0;
+}
+
+inline bool RadixHeap::empty() const
+{
+    return count == 0;
+}
+
+inline int RadixHeap::size() const
+{
+    return count;
+}
+
+inline void RadixHeap::push(const Pair<float, int>& item)
+{
+    buckets[Bucket(item.key)].push_back(item);
+    count++;
+}
+
+inline void RadixHeap::Refill()
+{
+    if(!buckets[0].empty()) return;
+
+    // Smallest key of the first non-empty bucket becomes "last",
+    // every item of that bucket moves to a lower bucket
+    int b = 1;
+    while(buckets[b].empty()) b++;
+
+    std::vector<Pair<float, int> >& bucket = buckets[b];
+    unsigned int minBits = Bits(bucket[0].key);
+    for(size_t i = 1; i < bucket.size(); i++)
+    {
+        unsigned int bits = Bits(bucket[i].key);
+        if(bits < minBits) minBits = bits;
+    }
+
+    last = minBits;
+    for(size_t i = 0; i < bucket.size(); i++)
+        buckets[Bucket(bucket[i].key)].push_back(bucket[i]);
+    bucket.clear();
+}
+
+inline const Pair<float, int>& RadixHeap::top()
+{
+    Refill();
+    return buckets[0].back();
+}
+
+inline void RadixHeap::pop()
+{
+    Refill();
+    buckets[0].pop_back();
+    count--;
+}
+
+#endif // INDEXED_HEAP_H
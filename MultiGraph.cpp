@@ -1,60 +1,416 @@
 #include "MultiGraph.h"
 #include "Exceptions.h"
 #include "IntPair.h"
+#include "IndexedHeap.h"
 #include <iostream>
 #include <iomanip>
-#include <fstream>
+#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <exception>
+#include <functional>
+#include <charconv>
+#include <string_view>
+#include <cstring>
+#include <cstdlib>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
-#define INF 5000.0
+#define INF std::numeric_limits<float>::infinity()
+
+namespace
+{
+    // Token of a map file line, points into the file buffer.
+    // Hash is computed by the tokenizer threads.
+    struct TextToken
+    {
+        const char*     data;
+        unsigned int    length;
+        unsigned int    hash;
+
+        std::string_view View() const
+        {
+            return std::string_view(data, length);
+        }
+    };
+
+    // A line of the map file
+    struct TextRecord
+    {
+        enum Type { VERTEX, EDGE, MISMATCH };
+
+        int             type;
+        TextToken       token[3];   // vertex | from, to, edge name
+        float           weight[2];
+    };
+
+    struct TextChunk
+    {
+        std::vector<TextRecord> records;
+        size_t                  vertexCount;
+    };
+
+    // Open addressing name -> id table over the token views,
+    // nothing is allocated per name (ids are given in insertion order)
+    class TokenTable
+    {
+        private:
+        struct Slot
+        {
+            unsigned int    hash;
+            int             id;     // -1 if empty
+        };
+
+        std::vector<Slot>               slots;
+        std::vector<std::string_view>   names;
+        size_t                          mask;
+
+        void Grow()
+        {
+            std::vector<Slot> old;
+            old.swap(slots);
+            slots.assign(old.size() * 2, Slot{0, -1});
+            mask = slots.size() - 1;
+            for(size_t i = 0; i < old.size(); i++)
+            {
+                if(old[i].id == -1) continue;
+                size_t s = old[i].hash & mask;
+                while(slots[s].id != -1) s = (s + 1) & mask;
+                slots[s] = old[i];
+            }
+        }
+
+        public:
+        explicit TokenTable(size_t expectedCount)
+        {
+            size_t capacity = 16;
+            while(capacity < expectedCount * 2) capacity *= 2;
+            slots.assign(capacity, Slot{0, -1});
+            mask = capacity - 1;
+            names.reserve(expectedCount);
+        }
+
+        int Find(const TextToken& token) const
+        {
+            std::string_view view = token.View();
+            for(size_t s = token.hash & mask; slots[s].id != -1; s = (s + 1) & mask)
+            {
+                if(slots[s].hash == token.hash && names[slots[s].id] == view)
+                    return slots[s].id;
+            }
+            return -1;
+        }
+
+        // Returns the id of the token, "inserted" is false if it was there
+        int Insert(const TextToken& token, bool& inserted)
+        {
+            std::string_view view = token.View();
+            size_t s = token.hash & mask;
+            for(; slots[s].id != -1; s = (s + 1) & mask)
+            {
+                if(slots[s].hash == token.hash && names[slots[s].id] == view)
+                {
+                    inserted = false;
+                    return slots[s].id;
+                }
+            }
+
+            inserted = true;
+            int id = static_cast<int>(names.size());
+            names.push_back(view);
+            slots[s] = Slot{token.hash, id};
+            if(names.size() * 2 > slots.size()) Grow();
+            return id;
+        }
+    };
+
+    inline bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' ||
+               c == '\v' || c == '\f';
+    }
+
+    inline TextToken MakeToken(std::string_view view)
+    {
+        TextToken token;
+        token.data = view.data();
+        token.length = static_cast<unsigned int>(view.size());
+        token.hash = static_cast<unsigned int>(std::hash<std::string_view>()(view));
+        return token;
+    }
+
+    // Same result as atof, from_chars handles the common case without
+    // copying the token (it does not accept a leading '+')
+    float ParseWeight(std::string_view token)
+    {
+        const char* begin = token.data();
+        const char* end = begin + token.size();
+        if(begin != end && *begin == '+') begin++;
+
+        float value;
+        std::from_chars_result result = std::from_chars(begin, end, value);
+        if(result.ec == std::errc() && result.ptr == end) return value;
+
+        // Out of range, trailing junk, hex etc.
+        char buffer[64];
+        size_t length = std::min(token.size(), sizeof(buffer) - 1);
+        std::memcpy(buffer, token.data(), length);
+        buffer[length] = '\0';
+        return static_cast<float>(std::atof(buffer));
+    }
+
+    // Tokenizes the lines on [begin, end), "begin" is a line start
+    // and "end" is either a line start or the end of the file
+    void TokenizeLines(TextChunk& chunk, const char* begin, const char* end)
+    {
+        std::string_view tokens[5];
+        chunk.vertexCount = 0;
+        while(begin < end)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+            if(lineEnd == NULL) lineEnd = end;
+
+            const char* p = begin;
+            begin = lineEnd + 1;
+            // Empty line and comment skip
+            if(p == lineEnd || *p == '#') continue;
+
+            int i = 0;
+            while(true)
+            {
+                while(p < lineEnd && IsSpace(*p)) p++;
+                if(p == lineEnd) break;
+
+                const char* tokenBegin = p;
+                while(p < lineEnd && !IsSpace(*p)) p++;
+                if(i < 5) tokens[i] = std::string_view(tokenBegin, p - tokenBegin);
+                i++;
+            }
+
+            TextRecord record;
+            if(i == 1)
+            {
+                record.type = TextRecord::VERTEX;
+                record.token[0] = MakeToken(tokens[0]);
+                chunk.vertexCount++;
+            }
+            else if(i == 5)
+            {
+                record.type = TextRecord::EDGE;
+                record.token[0] = MakeToken(tokens[0]);
+                record.token[1] = MakeToken(tokens[1]);
+                record.token[2] = MakeToken(tokens[2]);
+                record.weight[0] = ParseWeight(tokens[3]);
+                record.weight[1] = ParseWeight(tokens[4]);
+            }
+            else record.type = TextRecord::MISMATCH;
+            chunk.records.push_back(record);
+        }
+    }
+
+    // Edge line resolved to indices ("from" is -1 for a mismatch line)
+    struct ResolvedEdge
+    {
+        const TextRecord*   record;
+        int                 from;
+        GraphEdge           edge;
+    };
+
+    // Files smaller than this are tokenized on the caller thread
+    const size_t PARALLEL_LOAD_MIN_BYTES = 1 << 20;
+}
 
 MultiGraph::MultiGraph()
+    : tombstoneCount(0)
 {}
 
 MultiGraph::MultiGraph(const std::string& filePath)
+    : tombstoneCount(0)
 {
-    // Tokens
-    std::string tokens[5];
-    std::ifstream mapFile(filePath.c_str());
-
-    if(!mapFile.is_open())
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if(fd == -1)
     {
         std::cout << "Unable to open " << filePath << std::endl;
         return;
     }
 
-    // Read line by line
-    std::string line;
-    while (std::getline(mapFile, line))
+    // Map the whole file, tokens are views on the mapped pages
+    struct stat fileStat;
+    void* data = MAP_FAILED;
+    size_t size = 0;
+    if(fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+    {
+        size = static_cast<size_t>(fileStat.st_size);
+        data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if(data == MAP_FAILED) return;
+
+    try
+    {
+        LoadText(static_cast<const char*>(data), size);
+    }
+    catch(...)
+    {
+        munmap(data, size);
+        throw;
+    }
+    munmap(data, size);
+}
+
+void MultiGraph::LoadText(const char* text, size_t size)
+{
+    // Split the file on line boundaries, chunks are tokenized in parallel
+    int chunkCount = 1;
+    if(size >= PARALLEL_LOAD_MIN_BYTES)
+    {
+        chunkCount = std::thread::hardware_concurrency();
+        if(chunkCount < 1) chunkCount = 1;
+    }
+
+    std::vector<const char*> bounds(chunkCount + 1);
+    bounds[0] = text;
+    bounds[chunkCount] = text + size;
+    for(int c = 1; c < chunkCount; c++)
+    {
+        const char* p = text + size / chunkCount * c;
+        if(p < bounds[c - 1]) p = bounds[c - 1];
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', text + size - p));
+        bounds[c] = newline ? newline + 1 : text + size;
+    }
+
+    std::vector<TextChunk> chunks(chunkCount);
+    for(int c = 0; c < chunkCount; c++)
+        chunks[c].records.reserve((bounds[c + 1] - bounds[c]) / 16);
+
+    if(chunkCount == 1) TokenizeLines(chunks[0], bounds[0], bounds[1]);
+    else
+    {
+        std::vector<std::thread> threads;
+        for(int c = 0; c < chunkCount; c++)
+            threads.push_back(std::thread(TokenizeLines, std::ref(chunks[c]),
+                                          bounds[c], bounds[c + 1]));
+        for(int c = 0; c < chunkCount; c++) threads[c].join();
+    }
+
+    // Names are resolved as views, strings are made once per name.
+    // Records are resolved in file order; the first error stops the
+    // resolution and it is reported after the earlier lines are applied,
+    // so exceptions and mismatch messages come out exactly as the line
+    // by line loader.
+    size_t recordCount = 0, vertexRecordCount = 0;
+    for(int c = 0; c < chunkCount; c++)
     {
-        // Empty Line Skip
-        if(line.empty()) continue;
-        // Comment Skip
-        if(line[0] == '#') continue;
+        recordCount += chunks[c].records.size();
+        vertexRecordCount += chunks[c].vertexCount;
+    }
+
+    TokenTable vertexTokens(vertexRecordCount);
+    TokenTable edgeNameTokens(16);
+    std::vector<ResolvedEdge> resolved;
+    std::vector<int> outDegree, inDegree;
+    vertexList.reserve(vertexRecordCount);
+    outDegree.reserve(vertexRecordCount);
+    inDegree.reserve(vertexRecordCount);
+    resolved.reserve(recordCount - vertexRecordCount);
+
+    const TextRecord* errorRecord = NULL;
+    std::string errorName;
+    for(int c = 0; c < chunkCount && !errorRecord; c++)
+    {
+        const std::vector<TextRecord>& records = chunks[c].records;
+        for(size_t r = 0; r < records.size(); r++)
+        {
+            const TextRecord& record = records[r];
+            if(record.type == TextRecord::MISMATCH)
+            {
+                ResolvedEdge mismatch = {&record, -1, GraphEdge()};
+                resolved.push_back(mismatch);
+                continue;
+            }
+
+            bool inserted;
+            if(record.type == TextRecord::VERTEX)
+            {
+                vertexTokens.Insert(record.token[0], inserted);
+                if(!inserted)
+                {
+                    errorRecord = &record;
+                    break;
+                }
+
+                vertexList.push_back(GraphVertex());
+                vertexList.back().name.assign(record.token[0].data, record.token[0].length);
+                outDegree.push_back(0);
+                inDegree.push_back(0);
+                continue;
+            }
+
+            int from = vertexTokens.Find(record.token[0]);
+            int to = vertexTokens.Find(record.token[1]);
+            if(from == -1 || to == -1)
+            {
+                errorRecord = &record;
+                errorName = (from == -1) ? record.token[0].View() : record.token[1].View();
+                break;
+            }
+
+            int nameId = edgeNameTokens.Insert(record.token[2], inserted);
+            if(inserted) edgeNameTable.push_back(std::string(record.token[2].View()));
+
+            GraphEdge edge = {nameId, {record.weight[0], record.weight[1]}, to};
+            ResolvedEdge resolvedEdge = {&record, from, edge};
+            resolved.push_back(resolvedEdge);
+            outDegree[from]++;
+            inDegree[to]++;
+        }
+    }
 
-        // Tokenize the line
-        int i = 0;
-        std::istringstream stream(line);
-        while(stream >> tokens[i]) i++;
+    // Every list is allocated once
+    vertexIndex.reserve(vertexList.size());
+    for(size_t i = 0; i < vertexList.size(); i++)
+    {
+        GraphVertex& v = vertexList[i];
+        vertexIndex[v.name] = i;
+        v.edges.reserve(outDegree[i]);
+        v.edgeIndex.reserve(outDegree[i]);
+        v.inEdges.reserve(inDegree[i]);
+    }
+    for(size_t i = 0; i < edgeNameTable.size(); i++)
+        edgeNameIndex[edgeNameTable[i]] = i;
 
-        // Single token (Meaning it is a vertex)
-        if(i == 1)
+    // Adjacency in one pass, edges keep the file order
+    for(size_t e = 0; e < resolved.size(); e++)
+    {
+        const ResolvedEdge& r = resolved[e];
+        if(r.from == -1)
         {
-            InsertVertex(tokens[0]);
+            std::cerr << "Token Size Mismatch" << std::endl;
+            continue;
         }
-        // Exactly 5 tokens (Meaning it is an edge)
-        else if(i == 5)
+
+        GraphVertex& v = vertexList[r.from];
+        EdgeKey key = {r.edge.nameId, r.edge.endVertexIndex};
+        int slot = v.edges.size();
+        if(!v.edgeIndex.emplace(key, slot).second)
         {
-            // Rename vars for readablity
-            const std::string& vertexFromName = tokens[0];
-            const std::string& vertexToName = tokens[1];
-            const std::string& edgeName = tokens[2];
-            float weight0 = static_cast<float>(std::atof(tokens[3].c_str()));
-            float weight1 = static_cast<float>(std::atof(tokens[4].c_str()));
-            AddEdge(edgeName, vertexFromName, vertexToName,
-                    weight0, weight1);
+            throw SameNamedEdgeException(std::string(r.record->token[2].View()),
+                                         std::string(r.record->token[0].View()),
+                                         std::string(r.record->token[1].View()));
         }
-        else std::cerr << "Token Size Mismatch" << std::endl;
+
+        GraphInEdge inEdge = {r.from, slot};
+        v.edges.push_back(r.edge);
+        vertexList[r.edge.endVertexIndex].inEdges.push_back(inEdge);
     }
+
+    if(errorRecord == NULL) return;
+    if(errorRecord->type == TextRecord::VERTEX)
+        throw DuplicateVertexException(std::string(errorRecord->token[0].View()));
+    throw VertexNotFoundException(errorName);
 }
 
 void MultiGraph::PrintPath(const std::vector<int>& orderedVertexEdgeIndexList,
@@ -126,6 +482,8 @@ void MultiGraph::PrintEntireGraph() const
     for(size_t i = 0; i < vertexList.size(); i++)
     {
         const GraphVertex& v = vertexList[i];
+        if(v.removed) continue;
+
         std::cout << v.name << "\n";
         for(size_t j = 0; j < v.edges.size(); j++)
         {
@@ -139,7 +497,7 @@ void MultiGraph::PrintEntireGraph() const
                       << std::setw(4) << edge.weight[1]
                       << "-> ";
             std::cout << vertexList[edge.endVertexIndex].name;
-            std::cout << " (" << edge.name << ")" << "\n";
+            std::cout << " (" << edgeNameTable[edge.nameId] << ")" << "\n";
         }
     }
     // Reset fill value because it "sticks" to the std out
@@ -154,309 +512,1146 @@ float MultiGraph::Lerp(float w0, float w1, float alpha)
     return Beta;
 }
 
-void MultiGraph::InsertVertex(const std::string& vertexName)
+int MultiGraph::FindVertexIndex(const std::string& vertexName) const
 {
-    int size = vertexList.size();
+    std::unordered_map<std::string, int>::const_iterator it;
+    it = vertexIndex.find(vertexName);
     
-    for(int i=0;i<size;i++){
-        if(vertexList[i].name==vertexName) throw DuplicateVertexException(vertexName);
-    }
+    if(it == vertexIndex.end()) return -1;
+    return it->second;
+}
+
+int MultiGraph::FindEdgeNameId(const std::string& edgeName) const
+{
+    std::unordered_map<std::string, int>::const_iterator it;
+    it = edgeNameIndex.find(edgeName);
     
-    // The vertex can be added
+    if(it == edgeNameIndex.end()) return -1;
+    return it->second;
+}
+
+int MultiGraph::InternEdgeName(const std::string& edgeName)
+{
+    int nameId = FindEdgeNameId(edgeName);
+    if(nameId != -1) return nameId;
     
-    GraphVertex A;
-    A.name = vertexName;
-    vertexList.push_back(A);
+    nameId = edgeNameTable.size();
+    edgeNameTable.push_back(edgeName);
+    edgeNameIndex[edgeName] = nameId;
+    return nameId;
 }
 
-void MultiGraph::RemoveVertex(const std::string& vertexName)
+int MultiGraph::EdgeNameCount() const
+{
+    return edgeNameTable.size();
+}
+
+const std::string& MultiGraph::EdgeName(int nameId) const
+{
+    return edgeNameTable[nameId];
+}
+
+int MultiGraph::FindEdgeSlot(int vertexFromIndex,
+                             const std::string& edgeName,
+                             int vertexToIndex) const
 {
-    int size = vertexList.size(), i, j, I, edge_size, remEdgeInd;
-    bool flag = true;
+    const GraphVertex& v = vertexList[vertexFromIndex];
+    EdgeKey key = {FindEdgeNameId(edgeName), vertexToIndex};
+    if(key.nameId == -1) return -1;
     
-    for(i=0;i<size;i++){
-        if(vertexList[i].name==vertexName){ 
-            flag=false;
-            I=i;
-        }
-    }
+    std::unordered_map<EdgeKey, int, EdgeKeyHasher>::const_iterator it;
+    it = v.edgeIndex.find(key);
     
-    if(flag) throw VertexNotFoundException(vertexName);
+    if(it == v.edgeIndex.end()) return -1;
+    return it->second;
+}
+
+void MultiGraph::RebuildIndices()
+{
+    vertexIndex.clear();
     
-    // Start removing process now
+    for(int i=0;i<static_cast<int>(vertexList.size());i++){
+        GraphVertex& v = vertexList[i];
+        vertexIndex[v.name] = i;
+        
+        v.edgeIndex.clear();
+        v.inEdges.clear();
+    }
     
-    for(i=0;i<size;i++){
-        edge_size=vertexList[i].edges.size();
-        remEdgeInd=-1;
-        for(j=0;j<edge_size;j++){
-            if(vertexList[i].edges[j].endVertexIndex==I){
-                remEdgeInd=j;
-                break;
-            }
-        }
-        if(remEdgeInd!=-1){
-            vertexList[i].edges.erase(vertexList[i].edges.begin() + remEdgeInd);
+    for(int i=0;i<static_cast<int>(vertexList.size());i++){
+        GraphVertex& v = vertexList[i];
+        for(int j=0;j<static_cast<int>(v.edges.size());j++){
+            EdgeKey key = {v.edges[j].nameId, v.edges[j].endVertexIndex};
+            GraphInEdge inEdge = {i, j};
+            v.edgeIndex[key] = j;
+            vertexList[v.edges[j].endVertexIndex].inEdges.push_back(inEdge);
         }
     }
-    
-    vertexList.erase(vertexList.begin() + I);
-    
 }
 
-void MultiGraph::AddEdge(const std::string& edgeName,
-                         const std::string& vertexFromName,
-                         const std::string& vertexToName,
-                         float weight0, float weight1)
+void MultiGraph::RemoveInEdge(int vertexToIndex, int vertexFromIndex, int edgeSlot)
 {
-    int size = vertexList.size(), i, j, endVerInd;
-    bool flag1 = true, flag2 = true;
+    std::vector<GraphInEdge>& inEdges = vertexList[vertexToIndex].inEdges;
     
-    for(i=0;i<size;i++){
-        if(vertexList[i].name==vertexFromName) flag1=false;
-        if(vertexList[i].name==vertexToName){ 
-            flag2=false;
-            endVerInd = i;
+    for(int i=0;i<static_cast<int>(inEdges.size());i++){
+        if(inEdges[i].startVertexIndex==vertexFromIndex && inEdges[i].edgeSlot==edgeSlot){
+            inEdges[i] = inEdges.back();
+            inEdges.pop_back();
+            return;
         }
     }
+}
+
+void MultiGraph::InsertVertex(const std::string& vertexName)
+{
+    if(FindVertexIndex(vertexName) != -1) throw DuplicateVertexException(vertexName);
     
-    if(flag1) throw VertexNotFoundException(vertexFromName);
-    if(flag2) throw VertexNotFoundException(vertexToName);
+    // The vertex can be added
     
-    // The vertices exist
+    GraphVertex A;
+    A.name = vertexName;
+    vertexList.push_back(A);
+    vertexIndex[vertexName] = vertexList.size() - 1;
+    ClearLandmarks();
+}
+
+void MultiGraph::RemoveEdgesTo(int vertexFromIndex, int vertexToIndex)
+{
+    GraphVertex& v = vertexList[vertexFromIndex];
     
-    for(i=0;i<size;i++){
-        if(vertexList[i].name==vertexFromName){
-            
-            int edge_size=vertexList[i].edges.size();
+    // Stable compaction, shifted edges get their new slot on both
+    // "edgeIndex" and the in-edge list of their end vertex
+    int k = 0;
+    for(int j=0;j<static_cast<int>(v.edges.size());j++){
+        const GraphEdge& edge = v.edges[j];
+        EdgeKey key = {edge.nameId, edge.endVertexIndex};
+        
+        if(edge.endVertexIndex==vertexToIndex){
+            v.edgeIndex.erase(key);
+            continue;
+        }
+        
+        if(k!=j){
+            v.edges[k] = edge;
+            v.edgeIndex[key] = k;
             
-            for(j=0;j<edge_size;j++){
-                if(vertexList[i].edges[j].name==edgeName && vertexList[i].edges[j].endVertexIndex==endVerInd){ 
-                    throw SameNamedEdgeException(edgeName, vertexFromName, vertexToName);
+            std::vector<GraphInEdge>& inEdges = vertexList[edge.endVertexIndex].inEdges;
+            for(int i=0;i<static_cast<int>(inEdges.size());i++){
+                if(inEdges[i].startVertexIndex==vertexFromIndex && inEdges[i].edgeSlot==j){
+                    inEdges[i].edgeSlot = k;
+                    break;
                 }
             }
-            
-            GraphEdge E = {edgeName, {weight0, weight1}, endVerInd};
-            
-            vertexList[i].edges.push_back(E);
-            
         }
+        k++;
     }
-    
+    v.edges.resize(k);
 }
 
-void MultiGraph::RemoveEdge(const std::string& edgeName,
-                            const std::string& vertexFromName,
-                            const std::string& vertexToName)
+void MultiGraph::RemoveVertex(const std::string& vertexName)
 {
-    int size = vertexList.size(), i, j, startVerInd, remEdgeInd;
-    bool flag1 = true, flag2 = true, flag = true;
-    
-    for(i=0;i<size;i++){
-        if(vertexList[i].name==vertexFromName){ 
-            flag1=false;
-            startVerInd = i;
-        }
-        if(vertexList[i].name==vertexToName) flag2=false;
-    }
-    
-    if(flag1) throw VertexNotFoundException(vertexFromName);
-    if(flag2) throw VertexNotFoundException(vertexToName);
-    
-    // The vertices exist
+    int I = FindVertexIndex(vertexName);
+    if(I == -1) throw VertexNotFoundException(vertexName);
     
-    int edge_size = vertexList[startVerInd].edges.size();
+    GraphVertex& v = vertexList[I];
     
-    for(j=0;j<edge_size;j++){
-        if(vertexList[startVerInd].edges[j].name==edgeName){ 
-            flag=false;
-            remEdgeInd=j;
-        }
+    // Every incoming edge, a start vertex is compacted once
+    // even if it has several edges to "I"
+    std::vector<int> sources;
+    for(int i=0;i<static_cast<int>(v.inEdges.size());i++){
+        if(v.inEdges[i].startVertexIndex!=I) sources.push_back(v.inEdges[i].startVertexIndex);
     }
+    std::sort(sources.begin(), sources.end());
+    sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+    for(int i=0;i<static_cast<int>(sources.size());i++) RemoveEdgesTo(sources[i], I);
     
-    if(flag) throw EdgeNotFoundException(vertexFromName, edgeName);
+    // Every outgoing edge
+    for(int j=0;j<static_cast<int>(v.edges.size());j++){
+        if(v.edges[j].endVertexIndex!=I) RemoveInEdge(v.edges[j].endVertexIndex, I, j);
+    }
     
-    vertexList[startVerInd].edges.erase(vertexList[startVerInd].edges.begin() + remEdgeInd);
+    // Release the lists, only the name is kept (for printing old paths)
+    std::vector<GraphEdge>().swap(v.edges);
+    std::vector<GraphInEdge>().swap(v.inEdges);
+    std::unordered_map<EdgeKey, int, EdgeKeyHasher>().swap(v.edgeIndex);
+    v.removed = true;
     
+    vertexIndex.erase(vertexName);
+    tombstoneCount++;
 }
 
-bool MultiGraph::HeuristicShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
-                                       const std::string& vertexNameFrom,
-                                       const std::string& vertexNameTo,
-                                       float heuristicWeight) const
+void MultiGraph::Compact(std::vector<int>* newIndices)
 {
-    int size = vertexList.size(), i, j, FromInd, ToInd;
-    bool flag1 = true, flag2 = true, flag = false;
-    
-    for(i=0;i<size;i++){
-        if(vertexList[i].name==vertexNameFrom){ 
-            flag1=false;
-            FromInd = i;
-        }
-        if(vertexList[i].name==vertexNameTo){ 
-            flag2=false;
-            ToInd=i;
-        }
+    std::vector<int> remap(vertexList.size(), -1);
+    int k = 0;
+    for(int i=0;i<static_cast<int>(vertexList.size());i++){
+        if(vertexList[i].removed) continue;
+        
+        remap[i] = k;
+        if(k!=i) vertexList[k] = std::move(vertexList[i]);
+        k++;
     }
+    vertexList.resize(k);
     
-    if(flag1) throw VertexNotFoundException(vertexNameFrom);
-    if(flag2) throw VertexNotFoundException(vertexNameTo);
-    
-    // The vertices exist
-    
-    std::vector<float> distance(size, INF);
-    std::vector<int> previous(size);
-    MinPairHeap<float, int> PQ;
-    float dist, B;
-    int curr;
-    
-    PQ.push(Pair<float, int> {0, FromInd});
-    distance[FromInd]=0;
-    
-    while(!PQ.empty()){
-        dist=PQ.top().key;
-        curr=PQ.top().value;
-        
-        for(j=0;j<vertexList[curr].edges.size();j++){
-            B=Lerp(vertexList[curr].edges[j].weight[0],vertexList[curr].edges[j].weight[1], heuristicWeight);
-            
-            if(dist+B < distance[vertexList[curr].edges[j].endVertexIndex]){
-                distance[vertexList[curr].edges[j].endVertexIndex]=dist+B;
-                previous[vertexList[curr].edges[j].endVertexIndex]=curr;
-                
-                PQ.push(Pair<float, int>{dist+B, vertexList[curr].edges[j].endVertexIndex});
-            }
+    // Tombstones have no in-edges, every end vertex is alive
+    if(k!=static_cast<int>(remap.size())){
+        for(int i=0;i<static_cast<int>(vertexList.size());i++){
+            std::vector<GraphEdge>& edges = vertexList[i].edges;
+            for(int j=0;j<static_cast<int>(edges.size());j++) edges[j].endVertexIndex = remap[edges[j].endVertexIndex];
         }
-        
-        
-        
-        PQ.pop();
+        RebuildIndices();
+        ClearLandmarks();
     }
     
-    if(distance[ToInd]<INF) flag=true;
-    else return false;
+    tombstoneCount = 0;
+    if(newIndices) newIndices->swap(remap);
+}
+
+int MultiGraph::TombstoneCount() const
+{
+    return tombstoneCount;
+}
+
+void MultiGraph::AddEdge(const std::string& edgeName,
+                         const std::string& vertexFromName,
+                         const std::string& vertexToName,
+                         float weight0, float weight1)
+{
+    int startVerInd = FindVertexIndex(vertexFromName);
+    int endVerInd = FindVertexIndex(vertexToName);
+    
+    if(startVerInd == -1) throw VertexNotFoundException(vertexFromName);
+    if(endVerInd == -1) throw VertexNotFoundException(vertexToName);
     
-    std::vector<int> L;
+    // The vertices exist
     
-    for(curr=ToInd;curr!=FromInd;curr=previous[curr]){
-        
-        L.push_back(curr);
-        
-        size=vertexList[previous[curr]].edges.size();
-        for(i=0;i<size;i++){
-            if(vertexList[previous[curr]].edges[i].endVertexIndex==curr){
-                L.push_back(i);
-            }
-        }
-        
+    if(FindEdgeSlot(startVerInd, edgeName, endVerInd) != -1){
+        throw SameNamedEdgeException(edgeName, vertexFromName, vertexToName);
     }
     
-    orderedVertexEdgeIndexList.push_back(FromInd);
+    GraphVertex& v = vertexList[startVerInd];
+    GraphEdge E = {InternEdgeName(edgeName), {weight0, weight1}, endVerInd};
+    EdgeKey key = {E.nameId, endVerInd};
     
-    i=L.size()-1;
-    while(i){
-        orderedVertexEdgeIndexList.push_back(L[i]);
-        i--;
-    }
+    v.edges.push_back(E);
+    v.edgeIndex[key] = v.edges.size() - 1;
     
-    orderedVertexEdgeIndexList.push_back(ToInd);
+    GraphInEdge inEdge = {startVerInd, static_cast<int>(v.edges.size()) - 1};
+    vertexList[endVerInd].inEdges.push_back(inEdge);
     
-    return flag;
+    // New edge may shorten distances, bounds are not admissible anymore
+    ClearLandmarks();
 }
 
-bool MultiGraph::FilteredShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
-                                      const std::string& vertexNameFrom,
-                                      const std::string& vertexNameTo,
-                                      float heuristicWeight,
-                                      const std::vector<std::string>& edgeNames) const
+void MultiGraph::RemoveEdge(const std::string& edgeName,
+                            const std::string& vertexFromName,
+                            const std::string& vertexToName)
 {
-    int size = vertexList.size(), i, j, k, FromInd, ToInd;
-    bool flag1 = true, flag2 = true, flag = false;
-    
-    for(i=0;i<size;i++){
-        if(vertexList[i].name==vertexNameFrom){ 
-            flag1=false;
-            FromInd = i;
-        }
-        if(vertexList[i].name==vertexNameTo){ 
-            flag2=false;
-            ToInd=i;
-        }
-    }
+    int startVerInd = FindVertexIndex(vertexFromName);
+    int endVerInd = FindVertexIndex(vertexToName);
     
-    if(flag1) throw VertexNotFoundException(vertexNameFrom);
-    if(flag2) throw VertexNotFoundException(vertexNameTo);
+    if(startVerInd == -1) throw VertexNotFoundException(vertexFromName);
+    if(endVerInd == -1) throw VertexNotFoundException(vertexToName);
     
     // The vertices exist
     
-    std::vector<float> distance(size, INF);
-    std::vector<int> previous(size);
-    MinPairHeap<float, int> PQ;
-    float dist, B;
-    int curr;
-    flag1=true;
-    
-    PQ.push(Pair<float, int> {0, FromInd});
-    distance[FromInd]=0;
-    
-    while(!PQ.empty()){
-        dist=PQ.top().key;
-        curr=PQ.top().value;
-        
-        for(j=0;j<vertexList[curr].edges.size();j++){
-            
-            for(k=0;k<edgeNames.size();k++){
-                if(vertexList[curr].edges[j].name==edgeNames[k]) flag1=false;
-            }
-            
-            if(flag1){
-                B=Lerp(vertexList[curr].edges[j].weight[0],
-                       vertexList[curr].edges[j].weight[1], 
-                       heuristicWeight);
-                
-                if(dist+B < distance[vertexList[curr].edges[j].endVertexIndex]){
-                    distance[vertexList[curr].edges[j].endVertexIndex]=dist+B;
-                    previous[vertexList[curr].edges[j].endVertexIndex]=curr;
-                    
-                    PQ.push(Pair<float, int>{dist+B, vertexList[curr].edges[j].endVertexIndex});
-                }
-            }
-            flag1=true;
-        }
-        
-        
-        
-        PQ.pop();
-    }
+    int remEdgeInd = FindEdgeSlot(startVerInd, edgeName, endVerInd);
+    if(remEdgeInd == -1) throw EdgeNotFoundException(vertexFromName, edgeName);
     
-    if(distance[ToInd]<INF) flag=true;
-    else return false;
+    GraphVertex& v = vertexList[startVerInd];
+    EdgeKey key = {v.edges[remEdgeInd].nameId, endVerInd};
     
-    std::vector<int> L;
+    v.edges.erase(v.edges.begin() + remEdgeInd);
+    v.edgeIndex.erase(key);
+    RemoveInEdge(endVerInd, startVerInd, remEdgeInd);
     
-    for(curr=ToInd;curr!=FromInd;curr=previous[curr]){
-        
-        L.push_back(curr);
+    // Edges after the removed one are shifted by one slot
+    for(int j=remEdgeInd;j<static_cast<int>(v.edges.size());j++){
+        EdgeKey shifted = {v.edges[j].nameId, v.edges[j].endVertexIndex};
+        v.edgeIndex[shifted] = j;
         
-        size=vertexList[previous[curr]].edges.size();
-        for(i=0;i<size;i++){
-            if(vertexList[previous[curr]].edges[i].endVertexIndex==curr){
-                L.push_back(i);
+        std::vector<GraphInEdge>& inEdges = vertexList[v.edges[j].endVertexIndex].inEdges;
+        for(int k=0;k<static_cast<int>(inEdges.size());k++){
+            if(inEdges[k].startVertexIndex==startVerInd && inEdges[k].edgeSlot==j+1){
+                inEdges[k].edgeSlot = j;
+                break;
             }
         }
-        
     }
-    
-    orderedVertexEdgeIndexList.push_back(FromInd);
-    
-    i=L.size()-1;
-    while(i){
-        orderedVertexEdgeIndexList.push_back(L[i]);
-        i--;
+}
+
+void MultiGraph::BuildEdgeNameMask(EdgeNameMask& mask,
+                                   const std::vector<std::string>& edgeNames) const
+{
+    // Names that are not in the graph can not exclude anything
+    mask.words.assign((edgeNameTable.size() + 63) / 64, 0);
+    for(size_t k = 0; k < edgeNames.size(); k++)
+    {
+        int nameId = FindEdgeNameId(edgeNames[k]);
+        if(nameId != -1) mask.words[nameId >> 6] |= 1ull << (nameId & 63);
     }
-    
-    orderedVertexEdgeIndexList.push_back(ToInd);
-    
-    return flag;
+}
+
+void MultiGraph::BuildPath(std::vector<int>& orderedVertexEdgeIndexList,
+                           int fromIndex, int toIndex,
+                           const std::vector<int>& previous,
+                           const std::vector<int>& previousEdge) const
+{
+    // Walk back the predecessors, (vertex, edge) pairs are reversed
+    std::vector<int> L;
+    for(int curr = toIndex; curr != fromIndex; curr = previous[curr])
+    {
+        L.push_back(curr);
+        L.push_back(previousEdge[curr]);
+    }
+
+    orderedVertexEdgeIndexList.push_back(fromIndex);
+    for(int i = static_cast<int>(L.size()) - 1; i >= 0; i--)
+        orderedVertexEdgeIndexList.push_back(L[i]);
+}
+
+bool MultiGraph::ShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                              int fromIndex, int toIndex,
+                              float heuristicWeight,
+                              const EdgeNameMask& excluded,
+                              SearchStats* stats) const
+{
+    int size = vertexList.size();
+    std::vector<float> distance(size, INF);
+    std::vector<int> previous(size, -1);
+    std::vector<int> previousEdge(size, -1);
+    IndexedDaryHeap<float> PQ(size);
+    SearchStats s = {0, 0};
+
+    // A* if the blend is prepared, queue keys become "distance + bound".
+    // Bounds are computed once per vertex (negative means not computed).
+    const LandmarkTable* table = FindLandmarkTable(heuristicWeight);
+    std::vector<float> bound;
+    std::vector<float> targetFrom, targetTo;
+    if(table)
+    {
+        int k = table->landmarks.size();
+        bound.resize(size, -1);
+        targetFrom.resize(k);
+        targetTo.resize(k);
+        for(int l = 0; l < k; l++)
+        {
+            targetFrom[l] = table->fromLandmark[l * size + toIndex];
+            targetTo[l] = table->toLandmark[l * size + toIndex];
+        }
+        bound[fromIndex] = LandmarkBound(*table, size, fromIndex,
+                                         &targetFrom[0], &targetTo[0]);
+    }
+
+    PQ.push(Pair<float, int> {table ? bound[fromIndex] : 0, fromIndex});
+    distance[fromIndex] = 0;
+    s.pushCount++;
+
+    while(!PQ.empty())
+    {
+        // Indexed heap holds a vertex once, there is no stale entry
+        int curr = PQ.top().value;
+        float dist = distance[curr];
+        PQ.pop();
+        s.settledCount++;
+
+        // Point-to-point query, distance of the target is final
+        if(curr == toIndex) break;
+
+        const std::vector<GraphEdge>& edges = vertexList[curr].edges;
+        for(int j = 0; j < static_cast<int>(edges.size()); j++)
+        {
+            if(excluded.Contains(edges[j].nameId)) continue;
+
+            float B = Lerp(edges[j].weight[0], edges[j].weight[1], heuristicWeight);
+            int next = edges[j].endVertexIndex;
+            if(dist + B < distance[next])
+            {
+                float h = 0;
+                if(table)
+                {
+                    if(bound[next] < 0)
+                    {
+                        bound[next] = LandmarkBound(*table, size, next,
+                                                    &targetFrom[0], &targetTo[0]);
+                    }
+                    h = bound[next];
+                    // Target is not reachable from here
+                    if(!(h < INF)) continue;
+                }
+
+                distance[next] = dist + B;
+                previous[next] = curr;
+                previousEdge[next] = j;
+                PQ.push(Pair<float, int>{dist + B + h, next});
+                s.pushCount++;
+            }
+        }
+    }
+
+    if(stats) *stats = s;
+    if(!(distance[toIndex] < INF)) return false;
+
+    BuildPath(orderedVertexEdgeIndexList, fromIndex, toIndex,
+              previous, previousEdge);
+    return true;
+}
+
+bool MultiGraph::HeuristicShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                       const std::string& vertexNameFrom,
+                                       const std::string& vertexNameTo,
+                                       float heuristicWeight,
+                                       SearchStats* stats) const
+{
+    return FilteredShortestPath(orderedVertexEdgeIndexList,
+                                vertexNameFrom, vertexNameTo,
+                                heuristicWeight, std::vector<std::string>(),
+                                stats);
+}
+
+bool MultiGraph::FilteredShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                      const std::string& vertexNameFrom,
+                                      const std::string& vertexNameTo,
+                                      float heuristicWeight,
+                                      const std::vector<std::string>& edgeNames,
+                                      SearchStats* stats) const
+{
+    int FromInd = FindVertexIndex(vertexNameFrom);
+    int ToInd = FindVertexIndex(vertexNameTo);
+
+    if(FromInd == -1) throw VertexNotFoundException(vertexNameFrom);
+    if(ToInd == -1) throw VertexNotFoundException(vertexNameTo);
+
+    // The vertices exist
+
+    EdgeNameMask excluded;
+    BuildEdgeNameMask(excluded, edgeNames);
+    return ShortestPath(orderedVertexEdgeIndexList, FromInd, ToInd,
+                        heuristicWeight, excluded, stats);
+}
+
+bool MultiGraph::BiDirectionalShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                           const std::string& vertexNameFrom,
+                                           const std::string& vertexNameTo,
+                                           float heuristicWeight,
+                                           const std::vector<std::string>& edgeNames,
+                                           SearchStats* stats) const
+{
+    int FromInd = FindVertexIndex(vertexNameFrom);
+    int ToInd = FindVertexIndex(vertexNameTo);
+
+    if(FromInd == -1) throw VertexNotFoundException(vertexNameFrom);
+    if(ToInd == -1) throw VertexNotFoundException(vertexNameTo);
+
+    // The vertices exist
+
+    int size = vertexList.size();
+    EdgeNameMask excluded;
+    BuildEdgeNameMask(excluded, edgeNames);
+    // Forward search (from the source over "edges")
+    std::vector<float> distF(size, INF);
+    std::vector<int> previous(size, -1);
+    std::vector<int> previousEdge(size, -1);
+    MinPairHeap<float, int> PQF;
+    // Backward search (from the target over "inEdges")
+    std::vector<float> distB(size, INF);
+    std::vector<int> next(size, -1);
+    std::vector<int> nextEdge(size, -1);
+    MinPairHeap<float, int> PQB;
+    SearchStats s = {0, 0};
+
+    distF[FromInd] = 0;
+    distB[ToInd] = 0;
+    PQF.push(Pair<float, int>{0, FromInd});
+    PQB.push(Pair<float, int>{0, ToInd});
+    s.pushCount += 2;
+
+    // Best known path length and the vertex it passes through
+    float best = (FromInd == ToInd) ? 0 : INF;
+    int meet = (FromInd == ToInd) ? FromInd : -1;
+
+    while(!PQF.empty() && !PQB.empty())
+    {
+        // No path through an unsettled vertex can be shorter than this
+        if(PQF.top().key + PQB.top().key >= best) break;
+
+        // Expand the side with the smaller tentative distance
+        if(PQF.top().key <= PQB.top().key)
+        {
+            float dist = PQF.top().key;
+            int curr = PQF.top().value;
+            PQF.pop();
+            if(dist > distF[curr]) continue;
+            s.settledCount++;
+
+            const std::vector<GraphEdge>& edges = vertexList[curr].edges;
+            for(int j = 0; j < static_cast<int>(edges.size()); j++)
+            {
+                if(excluded.Contains(edges[j].nameId)) continue;
+
+                float B = Lerp(edges[j].weight[0], edges[j].weight[1], heuristicWeight);
+                int v = edges[j].endVertexIndex;
+                if(dist + B < distF[v])
+                {
+                    distF[v] = dist + B;
+                    previous[v] = curr;
+                    previousEdge[v] = j;
+                    PQF.push(Pair<float, int>{dist + B, v});
+                    s.pushCount++;
+                }
+                if(distF[v] + distB[v] < best)
+                {
+                    best = distF[v] + distB[v];
+                    meet = v;
+                }
+            }
+        }
+        else
+        {
+            float dist = PQB.top().key;
+            int curr = PQB.top().value;
+            PQB.pop();
+            if(dist > distB[curr]) continue;
+            s.settledCount++;
+
+            const std::vector<GraphInEdge>& inEdges = vertexList[curr].inEdges;
+            for(size_t j = 0; j < inEdges.size(); j++)
+            {
+                int u = inEdges[j].startVertexIndex;
+                const GraphEdge& edge = vertexList[u].edges[inEdges[j].edgeSlot];
+                if(excluded.Contains(edge.nameId)) continue;
+
+                float B = Lerp(edge.weight[0], edge.weight[1], heuristicWeight);
+                if(dist + B < distB[u])
+                {
+                    distB[u] = dist + B;
+                    next[u] = curr;
+                    nextEdge[u] = inEdges[j].edgeSlot;
+                    PQB.push(Pair<float, int>{dist + B, u});
+                    s.pushCount++;
+                }
+                if(distF[u] + distB[u] < best)
+                {
+                    best = distF[u] + distB[u];
+                    meet = u;
+                }
+            }
+        }
+    }
+
+    if(stats) *stats = s;
+    if(meet == -1) return false;
+
+    // Source -> meeting vertex, then follow the successors to the target
+    BuildPath(orderedVertexEdgeIndexList, FromInd, meet, previous, previousEdge);
+    for(int curr = meet; curr != ToInd; curr = next[curr])
+    {
+        orderedVertexEdgeIndexList.push_back(nextEdge[curr]);
+        orderedVertexEdgeIndexList.push_back(next[curr]);
+    }
+    return true;
+}
+
+bool MultiGraph::ParametricSolve(ParametricInterval& interval,
+                                 int fromIndex, int toIndex,
+                                 float heuristicWeight) const
+{
+    std::vector<int>& path = interval.orderedVertexEdgeIndexList;
+    path.clear();
+    EdgeNameMask excluded;
+    BuildEdgeNameMask(excluded, std::vector<std::string>());
+    if(!ShortestPath(path, fromIndex, toIndex, heuristicWeight,
+                     excluded, NULL))
+        return false;
+
+    interval.alphaBegin = heuristicWeight;
+    interval.alphaEnd = heuristicWeight;
+    interval.weight0 = 0;
+    interval.weight1 = 0;
+    for(size_t i = 0; i + 2 < path.size(); i += 2)
+    {
+        const GraphEdge& edge = vertexList[path[i]].edges[path[i + 1]];
+        interval.weight0 += edge.weight[0];
+        interval.weight1 += edge.weight[1];
+    }
+    return true;
+}
+
+void MultiGraph::ParametricSplit(std::vector<ParametricInterval>& intervals,
+                                 ParametricInterval right,
+                                 int fromIndex, int toIndex,
+                                 int depth) const
+{
+    // "left" (last interval) is optimal at its begin and "right" is
+    // optimal at its end, find the envelope between them
+    ParametricInterval& left = intervals.back();
+    float slopeLeft = left.weight1 - left.weight0;
+    float slopeRight = right.weight1 - right.weight0;
+
+    // Same line, "left" is optimal until the end of "right"
+    if(slopeLeft == slopeRight)
+    {
+        left.alphaEnd = right.alphaEnd;
+        return;
+    }
+
+    // Intersection of the two lines
+    float alpha = (right.weight0 - left.weight0) / (slopeLeft - slopeRight);
+    if(alpha < left.alphaBegin) alpha = left.alphaBegin;
+    if(alpha > right.alphaEnd) alpha = right.alphaEnd;
+
+    // Is there a path below both lines at the intersection?
+    ParametricInterval middle;
+    float lineCost = Lerp(left.weight0, left.weight1, alpha);
+    float epsilon = 1e-5f * (lineCost > 1 ? lineCost : 1);
+    bool split = depth < 64 &&
+                 alpha > left.alphaBegin && alpha < right.alphaEnd &&
+                 ParametricSolve(middle, fromIndex, toIndex, alpha) &&
+                 Lerp(middle.weight0, middle.weight1, alpha) < lineCost - epsilon;
+
+    if(!split)
+    {
+        // Breakpoint
+        left.alphaEnd = alpha;
+        right.alphaBegin = alpha;
+        intervals.push_back(right);
+        return;
+    }
+
+    middle.alphaEnd = alpha;
+    ParametricSplit(intervals, middle, fromIndex, toIndex, depth + 1);
+    ParametricSplit(intervals, right, fromIndex, toIndex, depth + 1);
+}
+
+bool MultiGraph::ParametricShortestPath(std::vector<ParametricInterval>& intervals,
+                                        const std::string& vertexNameFrom,
+                                        const std::string& vertexNameTo) const
+{
+    int FromInd = FindVertexIndex(vertexNameFrom);
+    int ToInd = FindVertexIndex(vertexNameTo);
+
+    if(FromInd == -1) throw VertexNotFoundException(vertexNameFrom);
+    if(ToInd == -1) throw VertexNotFoundException(vertexNameTo);
+
+    // The vertices exist
+
+    // Reachability does not depend on the blend
+    ParametricInterval first, last;
+    if(!ParametricSolve(first, FromInd, ToInd, 0)) return false;
+    ParametricSolve(last, FromInd, ToInd, 1);
+
+    intervals.clear();
+    intervals.push_back(first);
+    ParametricSplit(intervals, last, FromInd, ToInd, 0);
+    // Paths are equal at a breakpoint, drop the zero length intervals
+    std::vector<ParametricInterval> merged;
+    for(size_t i = 0; i < intervals.size(); i++)
+    {
+        if(intervals.size() > 1 && intervals[i].alphaEnd <= intervals[i].alphaBegin) continue;
+        merged.push_back(intervals[i]);
+    }
+    intervals.swap(merged);
+    return true;
+}
+
+const ParametricInterval* MultiGraph::FindInterval(const std::vector<ParametricInterval>& intervals,
+                                                   float heuristicWeight)
+{
+    // First interval that ends after the blend
+    int low = 0, high = static_cast<int>(intervals.size()) - 1;
+    if(high < 0) return NULL;
+
+    while(low < high)
+    {
+        int mid = (low + high) / 2;
+        if(intervals[mid].alphaEnd < heuristicWeight) low = mid + 1;
+        else high = mid;
+    }
+    return &intervals[low];
+}
+
+bool MultiGraph::ParetoShortestPaths(std::vector<ParetoPath>& frontier,
+                                     const std::string& vertexNameFrom,
+                                     const std::string& vertexNameTo,
+                                     int maxLabelsPerVertex,
+                                     SearchStats* stats) const
+{
+    int FromInd = FindVertexIndex(vertexNameFrom);
+    int ToInd = FindVertexIndex(vertexNameTo);
+
+    if(FromInd == -1) throw VertexNotFoundException(vertexNameFrom);
+    if(ToInd == -1) throw VertexNotFoundException(vertexNameTo);
+
+    // The vertices exist, the frontier is rebuilt (also left empty when
+    // the target is unreachable)
+    frontier.clear();
+
+    // Single criterion distances to the target are lower bounds of the
+    // remaining weights (blend 0 is weight[0] and 1 is weight[1])
+    std::vector<float> bound0, bound1;
+    Distances(bound0, ToInd, 0, true);
+    Distances(bound1, ToInd, 1, true);
+    if(!(bound0[FromInd] < INF)) return false;
+
+    // Labels are never deleted, dominated ones are marked as dead
+    struct Label
+    {
+        float   weight0;
+        float   weight1;
+        int     vertex;
+        int     previousLabel;
+        int     edgeSlot;
+        bool    dead;
+    };
+    std::vector<Label> labels;
+    std::vector<std::vector<int> > bags(vertexList.size());
+    MinPairHeap<float, int> PQ;
+    SearchStats s = {0, 0};
+
+    Label start = {0, 0, FromInd, -1, -1, false};
+    labels.push_back(start);
+    bags[FromInd].push_back(0);
+    PQ.push(Pair<float, int>{bound0[FromInd], 0});
+    s.pushCount++;
+
+    while(!PQ.empty())
+    {
+        int id = PQ.top().value;
+        PQ.pop();
+        if(labels[id].dead) continue;
+        s.settledCount++;
+
+        int curr = labels[id].vertex;
+        if(curr == ToInd) continue;
+
+        const std::vector<GraphEdge>& edges = vertexList[curr].edges;
+        for(int j = 0; j < static_cast<int>(edges.size()); j++)
+        {
+            int next = edges[j].endVertexIndex;
+            if(!(bound0[next] < INF)) continue;
+
+            float w0 = labels[id].weight0 + edges[j].weight[0];
+            float w1 = labels[id].weight1 + edges[j].weight[1];
+
+            // Prune by the found target labels (using the lower bounds)
+            bool dominated = false;
+            const std::vector<int>& targetBag = bags[ToInd];
+            for(size_t t = 0; t < targetBag.size() && !dominated; t++)
+            {
+                const Label& l = labels[targetBag[t]];
+                dominated = !l.dead &&
+                            l.weight0 <= w0 + bound0[next] &&
+                            l.weight1 <= w1 + bound1[next];
+            }
+
+            // Dominance against the labels of the vertex
+            std::vector<int>& bag = bags[next];
+            for(size_t t = 0; t < bag.size() && !dominated; t++)
+            {
+                const Label& l = labels[bag[t]];
+                dominated = l.weight0 <= w0 && l.weight1 <= w1;
+            }
+            if(dominated) continue;
+
+            // New label survives, drop the labels it dominates
+            size_t kept = 0;
+            for(size_t t = 0; t < bag.size(); t++)
+            {
+                Label& l = labels[bag[t]];
+                if(w0 <= l.weight0 && w1 <= l.weight1) l.dead = true;
+                else bag[kept++] = bag[t];
+            }
+            bag.resize(kept);
+            if(static_cast<int>(bag.size()) >= maxLabelsPerVertex) continue;
+
+            Label label = {w0, w1, next, id, j, false};
+            labels.push_back(label);
+            bag.push_back(static_cast<int>(labels.size()) - 1);
+            PQ.push(Pair<float, int>{w0 + bound0[next],
+                                     static_cast<int>(labels.size()) - 1});
+            s.pushCount++;
+        }
+    }
+
+    if(stats) *stats = s;
+
+    // Target bag is the frontier, order it by weight[0]
+    std::vector<Pair<float, int> > order;
+    for(size_t t = 0; t < bags[ToInd].size(); t++)
+        order.push_back(Pair<float, int>{labels[bags[ToInd][t]].weight0, bags[ToInd][t]});
+    std::sort(order.begin(), order.end(), LessComparator<Pair<float, int> >());
+
+    for(size_t t = 0; t < order.size(); t++)
+    {
+        ParetoPath path;
+        const Label& last = labels[order[t].value];
+        path.weight0 = last.weight0;
+        path.weight1 = last.weight1;
+
+        // Walk back the labels, (vertex, edge) pairs are reversed
+        std::vector<int> L;
+        for(int id = order[t].value; labels[id].previousLabel != -1; id = labels[id].previousLabel)
+        {
+            L.push_back(labels[id].vertex);
+            L.push_back(labels[id].edgeSlot);
+        }
+        path.orderedVertexEdgeIndexList.push_back(FromInd);
+        for(int i = static_cast<int>(L.size()) - 1; i >= 0; i--)
+            path.orderedVertexEdgeIndexList.push_back(L[i]);
+
+        frontier.push_back(path);
+    }
+    return true;
+}
+
+void MultiGraph::SearchFrom(ShortestPathTree& tree,
+                            int sourceIndex, float heuristicWeight,
+                            const EdgeNameMask& excluded,
+                            const std::vector<char>& isTarget,
+                            int targetCount) const
+{
+    int size = vertexList.size();
+    // Keys are monotone here (no bounds), radix heap is the fastest
+    RadixHeap PQ;
+
+    // Reuses the storage of the tree
+    std::vector<float>& distance = tree.distance;
+    std::vector<int>& previous = tree.previous;
+    std::vector<int>& previousEdge = tree.previousEdge;
+    tree.sourceIndex = sourceIndex;
+    tree.heuristicWeight = heuristicWeight;
+    distance.assign(size, INF);
+    previous.assign(size, -1);
+    previousEdge.assign(size, -1);
+
+    distance[sourceIndex] = 0;
+    PQ.push(Pair<float, int>{0, sourceIndex});
+    while(!PQ.empty())
+    {
+        float dist = PQ.top().key;
+        int curr = PQ.top().value;
+        PQ.pop();
+        if(dist > distance[curr]) continue;
+
+        if(targetCount > 0 && isTarget[curr] && --targetCount == 0) break;
+
+        const std::vector<GraphEdge>& edges = vertexList[curr].edges;
+        for(int j = 0; j < static_cast<int>(edges.size()); j++)
+        {
+            if(excluded.Contains(edges[j].nameId)) continue;
+
+            float B = Lerp(edges[j].weight[0], edges[j].weight[1], heuristicWeight);
+            int next = edges[j].endVertexIndex;
+            if(dist + B < distance[next])
+            {
+                distance[next] = dist + B;
+                previous[next] = curr;
+                previousEdge[next] = j;
+                PQ.push(Pair<float, int>{dist + B, next});
+            }
+        }
+    }
+}
+
+void MultiGraph::ShortestPathTreeFrom(ShortestPathTree& tree,
+                                      const std::string& vertexNameFrom,
+                                      float heuristicWeight) const
+{
+    FilteredShortestPathTreeFrom(tree, vertexNameFrom, heuristicWeight,
+                                 std::vector<std::string>());
+}
+
+void MultiGraph::FilteredShortestPathTreeFrom(ShortestPathTree& tree,
+                                              const std::string& vertexNameFrom,
+                                              float heuristicWeight,
+                                              const std::vector<std::string>& edgeNames) const
+{
+    int FromInd = FindVertexIndex(vertexNameFrom);
+    if(FromInd == -1) throw VertexNotFoundException(vertexNameFrom);
+
+    EdgeNameMask excluded;
+    BuildEdgeNameMask(excluded, edgeNames);
+    SearchFrom(tree, FromInd, heuristicWeight, excluded,
+               std::vector<char>(), 0);
+}
+
+bool MultiGraph::PathFromTree(std::vector<int>& orderedVertexEdgeIndexList,
+                              const ShortestPathTree& tree,
+                              const std::string& vertexNameTo) const
+{
+    int ToInd = FindVertexIndex(vertexNameTo);
+    if(ToInd == -1) throw VertexNotFoundException(vertexNameTo);
+
+    return tree.ExtractPath(orderedVertexEdgeIndexList, ToInd);
+}
+
+void MultiGraph::ManyToManyDistances(std::vector<float>& distances,
+                                     const std::vector<std::string>& origins,
+                                     const std::vector<std::string>& destinations,
+                                     float heuristicWeight,
+                                     int threadCount,
+                                     std::vector<std::vector<int> >* paths) const
+{
+    // Resolve every name before starting (throws on the caller thread)
+    std::vector<int> originIndices(origins.size());
+    std::vector<int> destinationIndices(destinations.size());
+    std::vector<char> isTarget(vertexList.size(), 0);
+    int targetCount = 0;
+    for(size_t i = 0; i < origins.size(); i++)
+    {
+        originIndices[i] = FindVertexIndex(origins[i]);
+        if(originIndices[i] == -1) throw VertexNotFoundException(origins[i]);
+    }
+    for(size_t i = 0; i < destinations.size(); i++)
+    {
+        destinationIndices[i] = FindVertexIndex(destinations[i]);
+        if(destinationIndices[i] == -1) throw VertexNotFoundException(destinations[i]);
+        if(!isTarget[destinationIndices[i]]) targetCount++;
+        isTarget[destinationIndices[i]] = 1;
+    }
+
+    int columns = destinations.size();
+    distances.assign(origins.size() * columns, INF);
+    if(paths)
+    {
+        paths->clear();
+        paths->resize(origins.size() * columns);
+    }
+    if(origins.empty() || destinations.empty()) return;
+
+    // Graph is not modified during the batch, workers only share the
+    // next origin counter and write disjoint rows
+    std::atomic<int> nextOrigin(0);
+    auto worker = [&]()
+    {
+        ShortestPathTree tree;
+        EdgeNameMask noFilter;
+        BuildEdgeNameMask(noFilter, std::vector<std::string>());
+        for(int o = nextOrigin++; o < static_cast<int>(origins.size()); o = nextOrigin++)
+        {
+            SearchFrom(tree, originIndices[o], heuristicWeight,
+                       noFilter, isTarget, targetCount);
+
+            for(int d = 0; d < columns; d++)
+            {
+                int target = destinationIndices[d];
+                distances[o * columns + d] = tree.Distance(target);
+                if(paths) tree.ExtractPath((*paths)[o * columns + d], target);
+            }
+        }
+    };
+
+    if(threadCount <= 0) threadCount = std::thread::hardware_concurrency();
+    if(threadCount > static_cast<int>(origins.size())) threadCount = origins.size();
+    if(threadCount <= 1)
+    {
+        worker();
+        return;
+    }
+
+    // An exception can not leave a thread (std::terminate), each worker
+    // keeps its own and stops the others by taking the remaining origins
+    std::vector<std::exception_ptr> errors(threadCount);
+    auto guardedWorker = [&](int t)
+    {
+        try
+        {
+            worker();
+        }
+        catch(...)
+        {
+            errors[t] = std::current_exception();
+            nextOrigin = origins.size();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    try
+    {
+        for(int t = 0; t < threadCount; t++) threads.push_back(std::thread(guardedWorker, t));
+    }
+    catch(...)
+    {
+        // Started threads must be joined before their vector is destroyed
+        nextOrigin = origins.size();
+        for(size_t t = 0; t < threads.size(); t++) threads[t].join();
+        throw;
+    }
+    for(int t = 0; t < threadCount; t++) threads[t].join();
+
+    for(int t = 0; t < threadCount; t++)
+        if(errors[t]) std::rethrow_exception(errors[t]);
+}
+
+void MultiGraph::Distances(std::vector<float>& distance,
+                           int sourceIndex, float heuristicWeight,
+                           bool backward) const
+{
+    int size = vertexList.size();
+    MinPairHeap<float, int> PQ;
+
+    distance.assign(size, INF);
+    distance[sourceIndex] = 0;
+    PQ.push(Pair<float, int>{0, sourceIndex});
+
+    while(!PQ.empty())
+    {
+        float dist = PQ.top().key;
+        int curr = PQ.top().value;
+        PQ.pop();
+        if(dist > distance[curr]) continue;
+
+        const GraphVertex& v = vertexList[curr];
+        int count = backward ? v.inEdges.size() : v.edges.size();
+        for(int j = 0; j < count; j++)
+        {
+            const GraphEdge* edge;
+            int next;
+            if(backward)
+            {
+                next = v.inEdges[j].startVertexIndex;
+                edge = &vertexList[next].edges[v.inEdges[j].edgeSlot];
+            }
+            else
+            {
+                edge = &v.edges[j];
+                next = edge->endVertexIndex;
+            }
+
+            float B = Lerp(edge->weight[0], edge->weight[1], heuristicWeight);
+            if(dist + B < distance[next])
+            {
+                distance[next] = dist + B;
+                PQ.push(Pair<float, int>{dist + B, next});
+            }
+        }
+    }
+}
+
+const LandmarkTable* MultiGraph::FindLandmarkTable(float heuristicWeight) const
+{
+    for(size_t i = 0; i < landmarkTables.size(); i++)
+    {
+        if(landmarkTables[i].heuristicWeight == heuristicWeight)
+            return &landmarkTables[i];
+    }
+    return NULL;
+}
+
+float MultiGraph::LandmarkBound(const LandmarkTable& table,
+                                int vertexCount, int vertexIndex,
+                                const float* targetFrom, const float* targetTo)
+{
+    // Unreachable entries produce "-inf" or "NaN" terms
+    // both of them fail the comparisons below and are ignored.
+    // An "inf" term means target is not reachable from the vertex.
+    float best = 0;
+    for(size_t l = 0; l < table.landmarks.size(); l++)
+    {
+        float a = targetFrom[l] - table.fromLandmark[l * vertexCount + vertexIndex];
+        float b = table.toLandmark[l * vertexCount + vertexIndex] - targetTo[l];
+        if(a > best) best = a;
+        if(b > best) best = b;
+    }
+    return best;
+}
+
+float MultiGraph::DistanceLowerBound(int fromIndex, int toIndex,
+                                     float heuristicWeight) const
+{
+    const LandmarkTable* table = FindLandmarkTable(heuristicWeight);
+    if(table == NULL) return 0;
+
+    int size = vertexList.size();
+    float best = 0;
+    for(size_t l = 0; l < table->landmarks.size(); l++)
+    {
+        float a = table->fromLandmark[l * size + toIndex] - table->fromLandmark[l * size + fromIndex];
+        float b = table->toLandmark[l * size + fromIndex] - table->toLandmark[l * size + toIndex];
+        if(a > best) best = a;
+        if(b > best) best = b;
+    }
+    return best;
+}
+
+void MultiGraph::PrepareLandmarks(int landmarkCount,
+                                  const std::vector<float>& heuristicWeights)
+{
+    int size = vertexList.size();
+    int first = 0;
+    while(first < size && vertexList[first].removed) first++;
+    if(landmarkCount > size - tombstoneCount) landmarkCount = size - tombstoneCount;
+
+    landmarkTables.clear();
+    if(landmarkCount <= 0) return;
+
+    for(size_t w = 0; w < heuristicWeights.size(); w++)
+    {
+        LandmarkTable table;
+        table.heuristicWeight = heuristicWeights[w];
+        table.fromLandmark.resize(landmarkCount * size);
+        table.toLandmark.resize(landmarkCount * size);
+
+        // Farthest selection: first landmark is the vertex farthest from
+        // the first vertex, next ones are the vertices farthest from all
+        // chosen landmarks (unreachable ones first so that every component
+        // gets a landmark). Tombstones are never chosen.
+        std::vector<float> distance;
+        std::vector<float> closest(size, INF);
+        for(int i = 0; i < size; i++)
+        {
+            if(vertexList[i].removed) closest[i] = -1;
+        }
+        int landmark = first;
+        Distances(distance, first, table.heuristicWeight, false);
+        for(int i = first + 1; i < size; i++)
+        {
+            if(distance[i] < INF && distance[i] > distance[landmark]) landmark = i;
+        }
+
+        for(int l = 0; l < landmarkCount; l++)
+        {
+            if(l != 0)
+            {
+                landmark = first;
+                for(int i = first + 1; i < size; i++)
+                {
+                    if(closest[i] > closest[landmark]) landmark = i;
+                }
+            }
+            table.landmarks.push_back(landmark);
+
+            Distances(distance, landmark, table.heuristicWeight, false);
+            std::copy(distance.begin(), distance.end(),
+                      table.fromLandmark.begin() + l * size);
+            for(int i = 0; i < size; i++)
+            {
+                if(distance[i] < closest[i]) closest[i] = distance[i];
+            }
+            closest[landmark] = -1;
+
+            Distances(distance, landmark, table.heuristicWeight, true);
+            std::copy(distance.begin(), distance.end(),
+                      table.toLandmark.begin() + l * size);
+        }
+        landmarkTables.push_back(table);
+    }
+}
+
+void MultiGraph::ClearLandmarks()
+{
+    landmarkTables.clear();
+}
+
+bool MultiGraph::HasLandmarks(float heuristicWeight) const
+{
+    return FindLandmarkTable(heuristicWeight) != NULL;
+}
+
+FrozenGraph MultiGraph::Freeze() const
+{
+    return FrozenGraph(*this);
 }
 
 int MultiGraph::BiDirectionalEdgeCount() const
@@ -469,7 +1664,7 @@ int MultiGraph::BiDirectionalEdgeCount() const
 
             for(k = 0; k < vertexList[destInd].edges.size(); k++){
                 if (vertexList[destInd].edges[k].endVertexIndex == i &&
-                    vertexList[destInd].edges[k].name == vertexList[i].edges[j].name) {
+                    vertexList[destInd].edges[k].nameId == vertexList[i].edges[j].nameId) {
                     count++;
                 }
             }
@@ -484,21 +1679,18 @@ int MultiGraph::MaxDepthViaEdgeName(const std::string& vertexName,
                                     const std::string& edgeName) const
 {
     int size = vertexList.size(), i, count=0, startInd;
-    bool flag = true;
+    bool flag;
     
-    for(i=0;i<size;i++){
-        if(vertexList[i].name==vertexName){ 
-            flag=false;
-            startInd=i;
-        }
-    }
+    startInd = FindVertexIndex(vertexName);
+    if(startInd == -1) throw VertexNotFoundException(vertexName);
     
-    if(flag) throw VertexNotFoundException(vertexName);
+    // Unknown name (-1) matches no edge
+    int nameId = FindEdgeNameId(edgeName);
     
     // The vertex exists
     
     std::vector<int> depth(size, 0);
-    MinPairHeap<int, int> Q;
+    IndexedDaryHeap<int> Q(size);
     int d, curr;
     flag=false;
     
@@ -507,12 +1699,14 @@ int MultiGraph::MaxDepthViaEdgeName(const std::string& vertexName,
     while(!Q.empty()){
         d=Q.top().key;
         curr=Q.top().value;
+        // Pop before relaxing, pushes may update the key of "curr"
+        Q.pop();
         
         for(i=0;i<vertexList[curr].edges.size();i++){
             
             if(vertexList[curr].edges[i].endVertexIndex==startInd) continue;
             
-            if(vertexList[curr].edges[i].name==edgeName){
+            if(vertexList[curr].edges[i].nameId==nameId){
                 flag=true;
             }
             
@@ -530,8 +1724,6 @@ int MultiGraph::MaxDepthViaEdgeName(const std::string& vertexName,
             flag=false;
             
         }
-        
-        Q.pop();
     }
     
     
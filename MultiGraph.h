@@ -3,28 +3,188 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include "FrozenGraph.h"
+#include "ShortestPathTree.h"
 
 struct GraphEdge
 {
-    std::string name;       // Name of the vertex
+    int         nameId;     // Interned name of the edge
+                            // (MultiGraph::EdgeName)
     float       weight[2];  // Weights of the edge
                             // (used on shortest path)
     int         endVertexIndex;
 };
 
+// Key of an edge on its start vertex
+// (same named edges are allowed only if they end on different vertices)
+struct EdgeKey
+{
+    int         nameId;
+    int         endVertexIndex;
+
+    inline bool operator==(const EdgeKey& other) const
+    {
+        return endVertexIndex == other.endVertexIndex &&
+               nameId == other.nameId;
+    }
+};
+
+struct EdgeKeyHasher
+{
+    inline size_t operator()(const EdgeKey& key) const
+    {
+        unsigned long long k = (static_cast<unsigned long long>(key.nameId) << 32) |
+                               static_cast<unsigned int>(key.endVertexIndex);
+        return std::hash<unsigned long long>()(k);
+    }
+};
+
+// Set of interned edge names, membership is a single bit test
+struct EdgeNameMask
+{
+    std::vector<unsigned long long> words;
+
+    inline bool Contains(int nameId) const
+    {
+        return (words[nameId >> 6] >> (nameId & 63)) & 1;
+    }
+};
+
+// Incoming edge, it refers to the edge stored on the start vertex
+struct GraphInEdge
+{
+    int         startVertexIndex;
+    int         edgeSlot;   // Index on "edges" of the start vertex
+};
+
+// Counters of a single search (for benchmarking the searches)
+struct SearchStats
+{
+    int         settledCount;   // Vertices popped from the queue(s)
+    int         pushCount;      // Queue insertions
+};
+
 struct GraphVertex
 {
-    std::vector<GraphEdge> edges; // Adjacency List
-    std::string            name;  // Name of the vertex
+    std::vector<GraphEdge>   edges;   // Adjacency List
+    std::vector<GraphInEdge> inEdges; // Reverse Adjacency List
+    std::string              name;    // Name of the vertex
+    // (edge name, end vertex) -> index on "edges"
+    std::unordered_map<EdgeKey, int, EdgeKeyHasher> edgeIndex;
+    // Tombstone, the vertex is removed but its index is not reused
+    // until MultiGraph::Compact (it has no edges and no name lookup)
+    bool                     removed = false;
+};
+
+// Landmark distance tables of a single blend, used as A* lower bounds
+// (ALT: A*, landmarks and triangle inequality)
+//
+// d(v, t) >= d(L, t) - d(L, v) and d(v, t) >= d(v, L) - d(t, L)
+// for every landmark L.
+struct LandmarkTable
+{
+    float               heuristicWeight;
+    std::vector<int>    landmarks;
+    std::vector<float>  fromLandmark;   // [l * |V| + v] = d(landmarks[l], v)
+    std::vector<float>  toLandmark;     // [l * |V| + v] = d(v, landmarks[l])
+};
+
+// Optimal path of the blend interval [alphaBegin, alphaEnd]
+// Cost of the path at blend "alpha" is Lerp(weight0, weight1, alpha)
+struct ParametricInterval
+{
+    float               alphaBegin;
+    float               alphaEnd;
+    float               weight0;    // Total weight[0] of the path
+    float               weight1;    // Total weight[1] of the path
+    std::vector<int>    orderedVertexEdgeIndexList;
+};
+
+// Pareto optimal path, no other path is better on both weights
+struct ParetoPath
+{
+    float               weight0;    // Total weight[0] of the path
+    float               weight1;    // Total weight[1] of the path
+    std::vector<int>    orderedVertexEdgeIndexList;
 };
 
 class MultiGraph
 {
+    friend class FrozenGraph;
+    friend class ContractionHierarchy;
+    friend class GraphBuilder;
+    friend class ShortestPathTreeCache;
+    template<class Table, class Policy> friend class RouteCache;
+    template<class Policy> friend class ConcurrentRouteCache;
+
     private:
     std::vector<GraphVertex>    vertexList;
+    // Vertex name -> index on "vertexList"
+    std::unordered_map<std::string, int> vertexIndex;
+    // Interned edge names (id -> name, name -> id)
+    std::vector<std::string>    edgeNameTable;
+    std::unordered_map<std::string, int> edgeNameIndex;
+    // ALT tables (one per prepared blend)
+    std::vector<LandmarkTable>  landmarkTables;
+    // Removed vertices still on "vertexList"
+    int                         tombstoneCount;
 
     static float Lerp(float w0, float w1, float alpha);
 
+    // Index lookups (returns -1 if not found)
+    int         FindVertexIndex(const std::string& vertexName) const;
+    int         FindEdgeSlot(int vertexFromIndex,
+                             const std::string& edgeName,
+                             int vertexToIndex) const;
+    int         FindEdgeNameId(const std::string& edgeName) const;
+    int         InternEdgeName(const std::string& edgeName);
+    void        RebuildIndices();
+    void        RemoveInEdge(int vertexToIndex, int vertexFromIndex, int edgeSlot);
+    // Removes every edge from "vertexFromIndex" to "vertexToIndex",
+    // remaining edges keep their order
+    void        RemoveEdgesTo(int vertexFromIndex, int vertexToIndex);
+    // Builds the graph from the map file contents (see the file constructor)
+    void        LoadText(const char* text, size_t size);
+
+    // Search internals
+    void        BuildEdgeNameMask(EdgeNameMask& mask,
+                                  const std::vector<std::string>& edgeNames) const;
+    void        BuildPath(std::vector<int>& orderedVertexEdgeIndexList,
+                          int fromIndex, int toIndex,
+                          const std::vector<int>& previous,
+                          const std::vector<int>& previousEdge) const;
+    bool        ShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                             int fromIndex, int toIndex,
+                             float heuristicWeight,
+                             const EdgeNameMask& excluded,
+                             SearchStats* stats) const;
+    // One-to-all Dijkstra, stops once every marked vertex is settled
+    // (all of them if "targetCount" is zero)
+    void        SearchFrom(ShortestPathTree& tree,
+                           int sourceIndex, float heuristicWeight,
+                           const EdgeNameMask& excluded,
+                           const std::vector<char>& isTarget,
+                           int targetCount) const;
+    // One-to-all distances over "edges" or "inEdges" (backward)
+    void        Distances(std::vector<float>& distance,
+                          int sourceIndex, float heuristicWeight,
+                          bool backward) const;
+    const LandmarkTable* FindLandmarkTable(float heuristicWeight) const;
+    bool        ParametricSolve(ParametricInterval& interval,
+                                int fromIndex, int toIndex,
+                                float heuristicWeight) const;
+    void        ParametricSplit(std::vector<ParametricInterval>& intervals,
+                                ParametricInterval right,
+                                int fromIndex, int toIndex,
+                                int depth) const;
+    static float LandmarkBound(const LandmarkTable& table,
+                               int vertexCount, int vertexIndex,
+                               const float* targetFrom, const float* targetTo);
+    // Lower bound of the distance (ALT bound if the blend is prepared, 0 otherwise)
+    float       DistanceLowerBound(int fromIndex, int toIndex,
+                                   float heuristicWeight) const;
+
     protected:
     public:
     // Constructors & Destructor
@@ -33,7 +193,15 @@ class MultiGraph
 
     // Connect Vertices
     void        InsertVertex(const std::string& vertexName);
+    // Tombstones the vertex, indices of the other vertices do not change
+    // (paths holding them stay valid). Cost is the degree of the vertex
+    // and of its in-neighbours, not O(V + E).
     void        RemoveVertex(const std::string& vertexName);
+    // Drops the tombstones and renumbers the vertices in bulk. If given,
+    // "newIndices" gets the new index of every old index (-1 if removed).
+    // Landmark tables are dropped.
+    void        Compact(std::vector<int>* newIndices = NULL);
+    int         TombstoneCount() const;
 
     // Connect Vertices
     void        AddEdge(const std::string& edgeName,
@@ -48,18 +216,87 @@ class MultiGraph
     bool        HeuristicShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
                                       const std::string& vertexNameFrom,
                                       const std::string& vertexNameTo,
-                                      float heuristicWeight) const;
+                                      float heuristicWeight,
+                                      SearchStats* stats = NULL) const;
     bool        FilteredShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
                                      const std::string& vertexNameFrom,
                                      const std::string& vertexNameTo,
                                      float heuristicWeight,
-                                     const std::vector<std::string>& edgeNames) const;
+                                     const std::vector<std::string>& edgeNames,
+                                     SearchStats* stats = NULL) const;
+    // Meets in the middle using the reverse adjacency,
+    // "edgeNames" are excluded as in FilteredShortestPath (may be empty)
+    bool        BiDirectionalShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                          const std::string& vertexNameFrom,
+                                          const std::string& vertexNameTo,
+                                          float heuristicWeight,
+                                          const std::vector<std::string>& edgeNames,
+                                          SearchStats* stats = NULL) const;
+
+    // Path cost is linear on the blend, so the optimal path is piecewise
+    // constant over [0, 1]. Returns every interval (ordered by alpha)
+    // with its optimal path; any blend is then served by FindInterval.
+    bool        ParametricShortestPath(std::vector<ParametricInterval>& intervals,
+                                       const std::string& vertexNameFrom,
+                                       const std::string& vertexNameTo) const;
+    static const ParametricInterval* FindInterval(const std::vector<ParametricInterval>& intervals,
+                                                  float heuristicWeight);
+    // Bi-criteria (weight[0], weight[1]) label setting search, returns the
+    // Pareto frontier ordered by weight[0]. A vertex holds at most
+    // "maxLabelsPerVertex" labels, beyond that frontier is approximate.
+    bool        ParetoShortestPaths(std::vector<ParetoPath>& frontier,
+                                    const std::string& vertexNameFrom,
+                                    const std::string& vertexNameTo,
+                                    int maxLabelsPerVertex = 64,
+                                    SearchStats* stats = NULL) const;
+
+    // One-to-all search, paths to every destination are then extracted
+    // from the tree (ShortestPathTree::ExtractPath or PathFromTree)
+    void        ShortestPathTreeFrom(ShortestPathTree& tree,
+                                     const std::string& vertexNameFrom,
+                                     float heuristicWeight) const;
+    void        FilteredShortestPathTreeFrom(ShortestPathTree& tree,
+                                             const std::string& vertexNameFrom,
+                                             float heuristicWeight,
+                                             const std::vector<std::string>& edgeNames) const;
+    bool        PathFromTree(std::vector<int>& orderedVertexEdgeIndexList,
+                             const ShortestPathTree& tree,
+                             const std::string& vertexNameTo) const;
+
+    // Many-to-many distances, one search per origin spread over
+    // "threadCount" workers (0 means hardware concurrency).
+    // "distances" is row major (origins x destinations), unreachable
+    // pairs are infinity. If "paths" is given it gets the same layout.
+    // An exception of a worker (e.g. std::bad_alloc) is rethrown on the
+    // caller thread once every worker is joined.
+    void        ManyToManyDistances(std::vector<float>& distances,
+                                    const std::vector<std::string>& origins,
+                                    const std::vector<std::string>& destinations,
+                                    float heuristicWeight,
+                                    int threadCount = 0,
+                                    std::vector<std::vector<int> >* paths = NULL) const;
+
+    // ALT preprocessing, shortest path queries on a prepared blend
+    // become A* searches. Tables are dropped by InsertVertex, AddEdge and
+    // Compact (they can shorten/renumber paths); RemoveEdge and
+    // RemoveVertex keep them since removing edges never decreases a
+    // distance.
+    void        PrepareLandmarks(int landmarkCount,
+                                 const std::vector<float>& heuristicWeights);
+    void        ClearLandmarks();
+    bool        HasLandmarks(float heuristicWeight) const;
+
+    // Read-only CSR snapshot for query serving
+    FrozenGraph Freeze() const;
 
     // Other functions
     int         BiDirectionalEdgeCount() const;
     int         MaxDepthViaEdgeName(const std::string& vertexName,
                                     const std::string& edgeName) const;
 
+    int         EdgeNameCount() const;
+    const std::string& EdgeName(int nameId) const;
+
     // Implemented Functions for Debugging
     void        PrintPath(const std::vector<int>& orderedVertexEdgeIndexList,
                           float heuristicWeight,
@@ -71,23 +308,12 @@ class MultiGraph
                          const std::string& vertexFromName,
                          const std::string& vertexToName) const
     {
-                int theIndex = -1, i;
-                
-                for(i=0; i<vertexList.size(); i++){
-                    if(vertexList[i].name == vertexFromName) theIndex = i;
-                }
-                
-                if(theIndex == -1) return false;
-                
-                for(i=0; i<vertexList[theIndex].edges.size(); i++){
-                    if(vertexList[theIndex].edges[i].name == edgeName
-                                &&          
-                        vertexList[vertexList[theIndex].edges[i].endVertexIndex].name == vertexToName){
-                            return true;
-                        }
-                }
-                
-                return false;
+                int fromIndex = FindVertexIndex(vertexFromName);
+                int toIndex = FindVertexIndex(vertexToName);
+
+                if(fromIndex == -1 || toIndex == -1) return false;
+
+                return FindEdgeSlot(fromIndex, edgeName, toIndex) != -1;
     }
     
 };
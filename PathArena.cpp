@@ -0,0 +1,192 @@
+#include "PathArena.h"
+#include <cstring>
+#include <utility>
+
+PathView::PathView()
+    : data(NULL)
+    , length(0)
+{}
+
+PathView::PathView(const unsigned char* data, int length)
+    : data(data)
+    , length(length)
+{}
+
+int PathView::Size() const
+{
+    return length;
+}
+
+bool PathView::Empty() const
+{
+    return length == 0;
+}
+
+int PathView::Front() const
+{
+    return *begin();
+}
+
+int PathView::Back() const
+{
+    int value = -1;
+    for(Iterator it = begin(); it != end(); ++it) value = *it;
+    return value;
+}
+
+PathView::Iterator PathView::begin() const
+{
+    Iterator it;
+    it.next = data;
+    it.index = 0;
+    it.length = length;
+    it.value = -1;
+    it.vertex = 0;
+    if(length > 0) it.Decode();
+    return it;
+}
+
+PathView::Iterator PathView::end() const
+{
+    Iterator it;
+    it.next = NULL;
+    it.index = length;
+    it.length = length;
+    it.value = -1;
+    it.vertex = 0;
+    return it;
+}
+
+void PathView::AppendTo(std::vector<int>& intArray) const
+{
+    if(length == 0) return;
+
+    size_t begin = intArray.size();
+    intArray.resize(begin + length);
+    int* out = &intArray[begin];
+
+    // Vertex, then (edge slot, vertex) pairs
+    const unsigned char* p = data;
+    int vertex = PathArena::UnZigZag(PathArena::GetVarint(p));
+    out[0] = vertex;
+    for(int i = 1; i + 1 < length; i += 2)
+    {
+        out[i] = static_cast<int>(PathArena::GetVarint(p));
+        vertex += PathArena::UnZigZag(PathArena::GetVarint(p));
+        out[i + 1] = vertex;
+    }
+
+    // Even length, the route ends with an edge slot
+    if(length % 2 == 0) out[length - 1] = static_cast<int>(PathArena::GetVarint(p));
+}
+
+PathArena::PathArena()
+    : garbage(0)
+{}
+
+unsigned char* PathArena::PutVarint(unsigned char* p, unsigned int value)
+{
+    while(value >= 0x80)
+    {
+        *p++ = static_cast<unsigned char>(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = static_cast<unsigned char>(value);
+    return p;
+}
+
+unsigned int PathArena::Append(const unsigned char* key, int keySize, const std::vector<int>& intArray)
+{
+    unsigned int offset = static_cast<unsigned int>(bytes.size());
+
+    // Sized for the longest encoding, trimmed after. Grows by half
+    // instead of doubling, the arena is most of the table memory.
+    size_t size = offset + keySize + MAX_VARINT_BYTES * intArray.size();
+    if(size > bytes.capacity()) bytes.reserve(size + size / 2);
+    bytes.resize(size);
+    unsigned char* p = &bytes[offset];
+    memcpy(p, key, keySize);
+    p += keySize;
+
+    int vertex = 0;
+    for(size_t i = 0; i < intArray.size(); i++)
+    {
+        if(i % 2 == 0)
+        {
+            p = PutVarint(p, ZigZag(intArray[i] - vertex));
+            vertex = intArray[i];
+        }
+        else
+        {
+            p = PutVarint(p, static_cast<unsigned int>(intArray[i]));
+        }
+    }
+    bytes.resize(p - &bytes[0]);
+    return offset;
+}
+
+unsigned int PathArena::Append(const PathArena& other, unsigned int offset, size_t size)
+{
+    unsigned int newOffset = static_cast<unsigned int>(bytes.size());
+    const unsigned char* record = &other.bytes[offset];
+    bytes.insert(bytes.end(), record, record + size);
+    return newOffset;
+}
+
+void PathArena::Release(size_t size)
+{
+    garbage += size;
+}
+
+void PathArena::Clear()
+{
+    bytes.clear();
+    garbage = 0;
+}
+
+void PathArena::Swap(PathArena& other)
+{
+    bytes.swap(other.bytes);
+    std::swap(garbage, other.garbage);
+}
+
+const unsigned char* PathArena::Record(unsigned int offset) const
+{
+    return &bytes[offset];
+}
+
+size_t PathArena::RouteSize(const unsigned char* route, int length)
+{
+    const unsigned char* p = route;
+    for(int i = 0; i < length; i++)
+    {
+        while(*p & 0x80) p++;
+        p++;
+    }
+    return p - route;
+}
+
+PathView PathArena::View(const unsigned char* route, int length)
+{
+    return PathView(route, length);
+}
+
+bool PathArena::NeedsCompaction() const
+{
+    return bytes.size() >= MIN_COMPACT_SIZE && garbage * 2 > bytes.size();
+}
+
+size_t PathArena::Size() const
+{
+    return bytes.size();
+}
+
+size_t PathArena::Garbage() const
+{
+    return garbage;
+}
+
+size_t PathArena::MemoryUsage() const
+{
+    return bytes.capacity();
+}
@@ -0,0 +1,168 @@
+#ifndef PATH_ARENA_H
+#define PATH_ARENA_H
+
+#include <vector>
+#include <cstddef>
+#include <iterator>
+// Read only view of a route encoded on a PathArena, iterates the
+// "orderedVertexEdgeIndexList" format without copying it (values are
+// decoded on the fly, Back walks the route). A view is valid until the
+// table holding the route is modified (Insert, Remove, RemoveLRU or
+// InvalidateTable).
+class PathView
+{
+    private:
+    const unsigned char*    data;       // First encoded element
+    int                     length;     // Element count
+
+    protected:
+    public:
+    class Iterator
+    {
+        friend class PathView;
+
+        private:
+        const unsigned char*    next;   // Next encoded element
+        int                     index;
+        int                     length;
+        int                     value;
+        int                     vertex; // Last decoded vertex
+
+        void        Decode();
+
+        protected:
+        public:
+        typedef std::forward_iterator_tag   iterator_category;
+        typedef int                         value_type;
+        typedef std::ptrdiff_t              difference_type;
+        typedef const int*                  pointer;
+        typedef const int&                  reference;
+
+        const int&  operator*() const { return value; }
+        Iterator&   operator++();
+        Iterator    operator++(int);
+        bool        operator==(const Iterator& other) const { return index == other.index; }
+        bool        operator!=(const Iterator& other) const { return index != other.index; }
+    };
+
+    // Constructors & Destructor
+                PathView();
+                PathView(const unsigned char* data, int length);
+
+    int         Size() const;
+    bool        Empty() const;
+    int         Front() const;
+    int         Back() const;
+    Iterator    begin() const;
+    Iterator    end() const;
+    // Appends the route to "intArray" (one allocation at most)
+    void        AppendTo(std::vector<int>& intArray) const;
+};
+
+// Append only storage of the routes of a HashTable.
+//
+// A record is the key, encoded by the key policy of the table (see
+// RouteKeyPolicy), then the route, varint encoded: every vertex is the
+// zigzag delta of the previous one (0 for the first), edge slots are as
+// is. Slots are small and paths are usually local, a hop is 2-4 bytes
+// instead of 8 on a std::vector<int> (which also has its own
+// allocation). The arena does not know the key size, records are
+// addressed by offset and sized by the table.
+//
+// Released records are counted as garbage, the table compacts the arena
+// (moving the live records to a new one) once they outweigh the live
+// bytes. Offsets are 32 bits.
+class PathArena
+{
+    private:
+    static const size_t MIN_COMPACT_SIZE = 4096;
+
+    std::vector<unsigned char>  bytes;
+    size_t                      garbage;
+
+    protected:
+    public:
+    static const int    MAX_VARINT_BYTES = 5;
+
+    // Constructors & Destructor
+                PathArena();
+
+    // Encoding helpers
+    static unsigned int ZigZag(int value);
+    static int  UnZigZag(unsigned int value);
+    static unsigned int GetVarint(const unsigned char*& p);
+    static unsigned char* PutVarint(unsigned char* p, unsigned int value);
+
+    // Appends the encoded key ("keySize" bytes) and the route, returns
+    // the offset of the record
+    unsigned int Append(const unsigned char* key, int keySize, const std::vector<int>& intArray);
+    // Copies a record of another arena, returns its new offset
+    unsigned int Append(const PathArena& other, unsigned int offset, size_t size);
+    // Marks "size" bytes of records as garbage
+    void        Release(size_t size);
+    void        Clear();
+    void        Swap(PathArena& other);
+
+    const unsigned char* Record(unsigned int offset) const;
+    // Encoded size of the route of "length" elements at "route"
+    static size_t RouteSize(const unsigned char* route, int length);
+    static PathView View(const unsigned char* route, int length);
+
+    bool        NeedsCompaction() const;
+    size_t      Size() const;
+    size_t      Garbage() const;
+    size_t      MemoryUsage() const;
+};
+
+inline void PathView::Iterator::Decode()
+{
+    if(index % 2 == 0)
+    {
+        vertex += PathArena::UnZigZag(PathArena::GetVarint(next));
+        value = vertex;
+    }
+    else
+    {
+        value = static_cast<int>(PathArena::GetVarint(next));
+    }
+}
+
+inline PathView::Iterator& PathView::Iterator::operator++()
+{
+    if(++index < length) Decode();
+    return *this;
+}
+
+inline PathView::Iterator PathView::Iterator::operator++(int)
+{
+    Iterator old = *this;
+    ++(*this);
+    return old;
+}
+
+inline unsigned int PathArena::ZigZag(int value)
+{
+    return (static_cast<unsigned int>(value) << 1) ^ static_cast<unsigned int>(value >> 31);
+}
+
+inline int PathArena::UnZigZag(unsigned int value)
+{
+    return static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1);
+}
+
+inline unsigned int PathArena::GetVarint(const unsigned char*& p)
+{
+    // Most values are a single byte
+    unsigned int value = *p++;
+    if(value < 0x80) return value;
+
+    value &= 0x7F;
+    for(int shift = 7; ; shift += 7)
+    {
+        unsigned int byte = *p++;
+        value |= (byte & 0x7F) << shift;
+        if(byte < 0x80) return value;
+    }
+}
+
+#endif // PATH_ARENA_H
@@ -0,0 +1,51 @@
+#include "QuerySignature.h"
+#include <algorithm>
+#include <cmath>
+
+QuerySignature QuerySignature::Make(QueryKind kind, float heuristicWeight,
+                                    const std::vector<std::string>& edgeNames)
+{
+    QuerySignature signature;
+    signature.filterHash = FilterHash(edgeNames);
+    signature.blend = QuantizeBlend(heuristicWeight);
+    signature.kind = static_cast<unsigned char>(kind);
+    return signature;
+}
+
+unsigned short QuerySignature::QuantizeBlend(float heuristicWeight)
+{
+    if(!(heuristicWeight > 0)) return 0;
+    if(heuristicWeight >= 1) return BLEND_SCALE;
+    return static_cast<unsigned short>(std::lround(heuristicWeight * BLEND_SCALE));
+}
+
+float QuerySignature::Quantize(float heuristicWeight)
+{
+    return static_cast<float>(QuantizeBlend(heuristicWeight)) / BLEND_SCALE;
+}
+
+unsigned long long QuerySignature::FilterHash(const std::vector<std::string>& edgeNames)
+{
+    if(edgeNames.empty()) return 0;
+
+    // Order and duplicates do not change the excluded set
+    std::vector<std::string> names(edgeNames);
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+
+    // FNV-1a, every name is terminated so {"ab"} and {"a", "b"} differ
+    unsigned long long h = 0xCBF29CE484222325ull;
+    for(size_t i = 0; i < names.size(); i++)
+    {
+        const std::string& name = names[i];
+        for(size_t c = 0; c < name.size(); c++)
+        {
+            h ^= static_cast<unsigned char>(name[c]);
+            h *= 0x100000001B3ull;
+        }
+        h ^= 0xFF;
+        h *= 0x100000001B3ull;
+    }
+    // 0 is kept for "no filter"
+    return (h == 0) ? 1 : h;
+}
@@ -0,0 +1,117 @@
+#ifndef QUERY_SIGNATURE_H
+#define QUERY_SIGNATURE_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+// Shortest path query functions of MultiGraph that return a single route
+enum QueryKind
+{
+    QUERY_HEURISTIC = 0,            // HeuristicShortestPath
+    QUERY_FILTERED,                 // FilteredShortestPath
+    QUERY_BIDIRECTIONAL             // BiDirectionalShortestPath
+};
+
+// Compact signature of a route query (the route cache key is the start
+// vertex, the end vertex and this).
+//
+// "blend" is the heuristic weight quantized to BLEND_SCALE steps, the
+// route is the optimal one for the quantized blend (Blend()), so queries
+// with blends closer than a step share it. The scale is a power of two,
+// dyadic blends (0, 0.25, 0.5, 1 ...) are exact; landmark tables should
+// be prepared with Quantize()'d blends to be used by cached searches.
+//
+// "filterHash" is a 64 bit hash of the excluded edge name set (sorted,
+// duplicates ignored, 0 if empty).
+//
+// A bool converts to the old key ("isCostWeighted", heuristic search on
+// blend 0 if true, blend 1 otherwise), numbers do not.
+struct QuerySignature
+{
+    static const int    BLEND_SCALE = 32768;
+
+    unsigned long long  filterHash;
+    unsigned short      blend;      // [0, BLEND_SCALE]
+    unsigned char       kind;       // QueryKind
+
+                QuerySignature();
+                QuerySignature(bool isCostWeighted);
+    // A number is most likely meant as a blend (see Make), it does not
+    // convert to the bool key
+                QuerySignature(int) = delete;
+                QuerySignature(float) = delete;
+                QuerySignature(double) = delete;
+
+    static QuerySignature Make(QueryKind kind, float heuristicWeight,
+                               const std::vector<std::string>& edgeNames);
+    static unsigned short QuantizeBlend(float heuristicWeight);
+    static float Quantize(float heuristicWeight);
+    static unsigned long long FilterHash(const std::vector<std::string>& edgeNames);
+
+    float       Blend() const;
+    unsigned int Hash() const;
+
+    bool        operator==(const QuerySignature& other) const;
+    bool        operator!=(const QuerySignature& other) const;
+};
+
+inline QuerySignature::QuerySignature()
+    : filterHash(0)
+    , blend(0)
+    , kind(QUERY_HEURISTIC)
+{}
+
+inline QuerySignature::QuerySignature(bool isCostWeighted)
+    : filterHash(0)
+    , blend(isCostWeighted ? 0 : BLEND_SCALE)
+    , kind(QUERY_HEURISTIC)
+{}
+
+inline float QuerySignature::Blend() const
+{
+    return static_cast<float>(blend) / BLEND_SCALE;
+}
+
+inline unsigned int QuerySignature::Hash() const
+{
+    unsigned long long h = filterHash ^ (static_cast<unsigned long long>(kind) << 16 | blend);
+    h *= 0x9E3779B97F4A7C15ull;
+    return static_cast<unsigned int>(h >> 32);
+}
+
+inline bool QuerySignature::operator==(const QuerySignature& other) const
+{
+    return filterHash == other.filterHash && blend == other.blend && kind == other.kind;
+}
+
+inline bool QuerySignature::operator!=(const QuerySignature& other) const
+{
+    return !(*this == other);
+}
+
+// Key of a cached route (the default HashTable key, see RouteKeyPolicy)
+struct RouteKey
+{
+    int         startInt;
+    int         endInt;
+    QuerySignature signature;
+
+    bool operator==(const RouteKey& other) const
+    {
+        return startInt == other.startInt && endInt == other.endInt &&
+               signature == other.signature;
+    }
+};
+
+struct RouteKeyHash
+{
+    size_t operator()(const RouteKey& key) const
+    {
+        size_t h = static_cast<unsigned int>(key.startInt);
+        h = h * 0x9E3779B1u + static_cast<unsigned int>(key.endInt);
+        return h * 0x9E3779B1u + key.signature.Hash();
+    }
+};
+
+#endif // QUERY_SIGNATURE_H
@@ -0,0 +1,193 @@
+#ifndef ROUTE_CACHE_H
+#define ROUTE_CACHE_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <unordered_map>
+#include "HashTable.h"
+#include "GrowableHashTable.h"
+#include "EvictionPolicy.h"
+#include "ShortestPathTreeCache.h"
+#include "MultiGraph.h"
+
+// Route cache of a MultiGraph with dependency tracked invalidation.
+//
+// Routes are stored on a "Table" (HashTable<MAX_SIZE> or the default
+// GrowableHashTable, same key: start vertex, end vertex and the
+// QuerySignature) in the "orderedVertexEdgeIndexList" format. Heuristic,
+// filtered and bidirectional queries of any blend and excluded edge set
+// are cached, a route is optimal for the quantized blend of its
+// signature (see QuerySignature). ShortestPath is the old cost weighted
+// query (blend 0 if "isCostWeighted", blend 1 otherwise).
+//
+// The cache keeps a reverse index (vertex -> keys of the routes visiting
+// it). An edge is tracked through its start vertex, a route depends on
+// the edge if it leaves that vertex through the edge slot. Graph edits
+// should be done through the cache so that only the affected routes are
+// touched instead of invalidating the whole table:
+//
+// RemoveEdge   : routes using the edge are evicted, routes using a later
+//                slot of the same vertex get their slot renumbered.
+// RemoveVertex : routes visiting the vertex are evicted, routes through
+//                its in-neighbours are renumbered.
+// AddEdge      : a route s -> t of cost D is evicted only if the new edge
+//                u -> v (cost w) may improve it, d(s, u) + w + d(v, t) < D.
+//                Routes visiting u or v (reverse index) use their exact
+//                prefix/suffix cost, and a landmark lower bound (see
+//                MultiGraph::PrepareLandmarks) for the side that is not on
+//                the route. The other routes are tested on landmark bounds
+//                if their blend is prepared and evicted otherwise.
+//                MultiGraph::AddEdge and InsertVertex drop the landmark
+//                tables: from the second AddEdge of a batch on, every
+//                route not visiting the end points of the new edge is
+//                evicted (near full invalidation) unless PrepareLandmarks
+//                is called again between the edits.
+// Compact      : routes are renumbered.
+// Removing edges never shortens a path, so other routes stay optimal.
+//
+// Every subpath of a shortest path is a shortest path (same blend and
+// excluded edges), a query missing its exact key is answered from a
+// cached route of the same signature visiting the start vertex and then
+// the end vertex, found through the reverse index (FindSubpath).
+//
+// Sources asked about many destinations get a shortest path tree tier
+// (see ShortestPathTreeCache, "treeMemory" bytes, disabled if 0). A
+// query missing its key is walked on the tree of its source if there is
+// one, it is not inserted as a route; the tree is built once the source
+// misses often enough.
+//
+// Eviction is done by the "Policy" (see EvictionPolicy.h), each route
+// has a handle on it. If the cache has a capacity, inserting a new route
+// on a full cache evicts the policy victim first. A fixed size table
+// that is full (TableCapFullException) is handled the same way.
+// Renumbered routes keep their place on the policy.
+//
+// USAGE:
+//
+// RouteCache<> cache(graph, 4096);         // GrowableHashTable, LRU
+// RouteCache<HashTable<1021>, ClockPolicy> fixed(graph, 510);
+// RouteCache<> tiered(graph, 4096, 64 << 20); // and 64MB of trees
+// cache.ShortestPath(path, "IST", "ESB", true);
+// cache.AddEdge("TK2124", "IST", "ESB", 60, 45);
+template<class Table = GrowableHashTable, class Policy = LRUPolicy>
+class RouteCache
+{
+    private:
+    MultiGraph&                         graph;
+    Table                               table;
+    Policy                              policy;
+    int                                 capacity;       // 0 if unbounded
+    // Vertex index -> keys of the cached routes visiting it
+    // (a key is listed once per vertex)
+    std::vector<std::vector<RouteKey> > vertexRoutes;
+    int                                 routeCount;
+    // Policy handles (freed handles are reused)
+    std::unordered_map<RouteKey, int, RouteKeyHash> handles;
+    std::vector<RouteKey>               handleKeys;
+    std::vector<int>                    freeHandles;
+    ShortestPathTreeCache               trees;
+
+    float       PathCost(const std::vector<int>& intArray, float heuristicWeight) const;
+    // AddEdge test of a route, u -> v of cost "edgeCost" may shorten it
+    bool        MayImprove(const std::vector<int>& intArray, float alpha,
+                           int u, int v, float edgeCost) const;
+
+    // Reverse index maintenance
+    void        IndexRoute(const std::vector<int>& intArray, const QuerySignature& signature);
+    void        UnindexRoute(const std::vector<int>& intArray, const QuerySignature& signature);
+    // Keys of the routes visiting the vertex (empty if none)
+    void        RoutesOf(std::vector<RouteKey>& keys, int vertexIndex) const;
+    int         AcquireHandle(const RouteKey& key);
+    // Removes the route from the table and the index (and from the
+    // policy unless it is its victim)
+    void        Drop(const RouteKey& key, bool isVictim);
+    void        Evict(int startInt, int endInt, const QuerySignature& signature);
+    // Evicts the policy victim (false if the cache is empty)
+    bool        EvictVictim();
+    // Cached query of any kind, "edgeNames" must match the signature
+    bool        Query(std::vector<int>& orderedVertexEdgeIndexList,
+                      const std::string& vertexNameFrom,
+                      const std::string& vertexNameTo,
+                      const QuerySignature& signature,
+                      const std::vector<std::string>& edgeNames);
+    // Shifts edge slots of the routes visiting "vertexIndex",
+    // "removedSlots" is sorted (old slots of the removed edges)
+    void        RenumberSlots(int vertexIndex, const std::vector<int>& removedSlots);
+
+    protected:
+    public:
+    // Constructors & Destructor
+    explicit    RouteCache(MultiGraph& graph, int capacity = 0,
+                           size_t treeMemory = 0);
+
+    const MultiGraph& Graph() const;
+    const ShortestPathTreeCache& Trees() const;
+
+    // Table access (same semantics as HashTable), "incLRU" touches
+    // the route on the policy, Insert never throws TableCapFullException
+    int         Insert(const std::vector<int>& intArray, const QuerySignature& signature);
+    bool        Find(std::vector<int>& intArray,
+                     int startInt, int endInt, const QuerySignature& signature,
+                     bool incLRU = false);
+    // Subpath "startInt" ... "endInt" of a cached route of the same
+    // signature (the route is touched if "incLRU"), the shorter of the
+    // two vertex route lists is scanned
+    bool        FindSubpath(std::vector<int>& intArray,
+                            int startInt, int endInt, const QuerySignature& signature,
+                            bool incLRU = false);
+    void        Remove(int startInt, int endInt, const QuerySignature& signature);
+    // Evicts that many policy victims (O(1) each)
+    void        RemoveLRU(int lruElementCount);
+    // Drops the routes and the trees
+    void        InvalidateTable();
+    int         RouteCount() const;
+    int         Capacity() const;
+
+    // Shortest paths through the cache, a miss is searched on the graph
+    // (MultiGraph function of the same name) and inserted
+    bool        ShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                             const std::string& vertexNameFrom,
+                             const std::string& vertexNameTo,
+                             bool isCostWeighted);
+    bool        HeuristicShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                      const std::string& vertexNameFrom,
+                                      const std::string& vertexNameTo,
+                                      float heuristicWeight);
+    bool        FilteredShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                     const std::string& vertexNameFrom,
+                                     const std::string& vertexNameTo,
+                                     float heuristicWeight,
+                                     const std::vector<std::string>& edgeNames);
+    bool        BiDirectionalShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                          const std::string& vertexNameFrom,
+                                          const std::string& vertexNameTo,
+                                          float heuristicWeight,
+                                          const std::vector<std::string>& edgeNames);
+
+    // Uncached search of the query of a signature ("edgeNames" must
+    // match it), the graph search of a cache miss
+    static bool Search(const MultiGraph& graph,
+                       std::vector<int>& orderedVertexEdgeIndexList,
+                       const std::string& vertexNameFrom,
+                       const std::string& vertexNameTo,
+                       const QuerySignature& signature,
+                       const std::vector<std::string>& edgeNames);
+
+    // Graph edits with targeted invalidation
+    void        InsertVertex(const std::string& vertexName);
+    void        RemoveVertex(const std::string& vertexName);
+    void        AddEdge(const std::string& edgeName,
+                        const std::string& vertexFromName,
+                        const std::string& vertexToName,
+                        float weight0, float weight1);
+    void        RemoveEdge(const std::string& edgeName,
+                           const std::string& vertexFromName,
+                           const std::string& vertexToName);
+    void        Compact();
+};
+
+// Template Implementation
+#include "RouteCacheImpl.h"
+
+#endif // ROUTE_CACHE_H
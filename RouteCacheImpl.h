@@ -0,0 +1,636 @@
+#ifndef ROUTE_CACHE_HPP
+#define ROUTE_CACHE_HPP
+
+#include <algorithm>
+#include <unordered_set>
+
+template<class Table, class Policy>
+RouteCache<Table, Policy>::RouteCache(MultiGraph& g, int capacity, size_t treeMemory)
+    : graph(g)
+    , capacity(capacity)
+    , routeCount(0)
+    , trees(treeMemory)
+{}
+
+template<class Table, class Policy>
+const MultiGraph& RouteCache<Table, Policy>::Graph() const
+{
+    return graph;
+}
+
+template<class Table, class Policy>
+const ShortestPathTreeCache& RouteCache<Table, Policy>::Trees() const
+{
+    return trees;
+}
+
+template<class Table, class Policy>
+float RouteCache<Table, Policy>::PathCost(const std::vector<int>& intArray,
+                                             float heuristicWeight) const
+{
+    float cost = 0;
+    for(size_t i = 1; i + 1 < intArray.size(); i += 2)
+    {
+        const GraphEdge& edge = graph.vertexList[intArray[i - 1]].edges[intArray[i]];
+        cost += MultiGraph::Lerp(edge.weight[0], edge.weight[1], heuristicWeight);
+    }
+    return cost;
+}
+
+template<class Table, class Policy>
+void RouteCache<Table, Policy>::IndexRoute(const std::vector<int>& intArray, const QuerySignature& signature)
+{
+    RouteKey key = {intArray[0], intArray[intArray.size() - 1], signature};
+
+    // Vertices are on the even positions, a vertex is indexed once
+    std::vector<int> vertices;
+    for(size_t i = 0; i < intArray.size(); i += 2) vertices.push_back(intArray[i]);
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+    if(vertices.back() >= static_cast<int>(vertexRoutes.size()))
+        vertexRoutes.resize(vertices.back() + 1);
+    for(size_t i = 0; i < vertices.size(); i++)
+        vertexRoutes[vertices[i]].push_back(key);
+}
+
+template<class Table, class Policy>
+void RouteCache<Table, Policy>::UnindexRoute(const std::vector<int>& intArray, const QuerySignature& signature)
+{
+    int startInt = intArray[0];
+    int endInt = intArray[intArray.size() - 1];
+
+    for(size_t i = 0; i < intArray.size(); i += 2)
+    {
+        std::vector<RouteKey>& keys = vertexRoutes[intArray[i]];
+        for(size_t k = 0; k < keys.size(); k++)
+        {
+            if(keys[k].startInt == startInt && keys[k].endInt == endInt &&
+               keys[k].signature == signature)
+            {
+                keys[k] = keys.back();
+                keys.pop_back();
+                break;
+            }
+        }
+    }
+}
+
+template<class Table, class Policy>
+void RouteCache<Table, Policy>::RoutesOf(std::vector<RouteKey>& keys, int vertexIndex) const
+{
+    keys.clear();
+    if(vertexIndex < static_cast<int>(vertexRoutes.size()))
+        keys = vertexRoutes[vertexIndex];
+}
+
+template<class Table, class Policy>
+bool RouteCache<Table, Policy>::MayImprove(const std::vector<int>& intArray, float alpha,
+                                           int u, int v, float edgeCost) const
+{
+    // Prefix cost to "u" and suffix cost from "v" if they are on the route
+    float cost = 0, toU = -1, atV = -1;
+    for(size_t i = 0; i < intArray.size(); i += 2)
+    {
+        if(intArray[i] == u && toU < 0) toU = cost;
+        if(intArray[i] == v) atV = cost;
+        if(i + 1 < intArray.size())
+        {
+            const GraphEdge& edge = graph.vertexList[intArray[i]].edges[intArray[i + 1]];
+            cost += MultiGraph::Lerp(edge.weight[0], edge.weight[1], alpha);
+        }
+    }
+
+    float fromV = (atV < 0) ? graph.DistanceLowerBound(v, intArray.back(), alpha) : cost - atV;
+    if(toU < 0) toU = graph.DistanceLowerBound(intArray.front(), u, alpha);
+    return toU + edgeCost + fromV < cost;
+}
+
+template<class Table, class Policy>
+int RouteCache<Table, Policy>::AcquireHandle(const RouteKey& key)
+{
+    int handle;
+    if(freeHandles.empty())
+    {
+        handle = static_cast<int>(handleKeys.size());
+        handleKeys.push_back(key);
+    }
+    else
+    {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+        handleKeys[handle] = key;
+    }
+    handles[key] = handle;
+    return handle;
+}
+
+template<class Table, class Policy>
+void RouteCache<Table, Policy>::Drop(const RouteKey& key, bool isVictim)
+{
+    std::unordered_map<RouteKey, int, RouteKeyHash>::iterator it = handles.find(key);
+    if(it == handles.end()) return;
+
+    std::vector<int> removed;
+    table.Remove(removed, key.startInt, key.endInt, key.signature);
+    UnindexRoute(removed, key.signature);
+
+    if(!isVictim) policy.Remove(it->second);
+    freeHandles.push_back(it->second);
+    handles.erase(it);
+    routeCount--;
+}
+
+template<class Table, class Policy>
+void RouteCache<Table, Policy>::Evict(int startInt, int endInt, const QuerySignature& signature)
+{
+    RouteKey key = {startInt, endInt, signature};
+    Drop(key, false);
+}
+
+template<class Table, class Policy>
+bool RouteCache<Table, Policy>::EvictVictim()
+{
+    int handle = policy.Victim();
+    if(handle == -1) return false;
+
+    // Copied, the slot is reused
+    RouteKey key = handleKeys[handle];
+    Drop(key, true);
+    return true;
+}
+
+template<class Table, class Policy>
+void RouteCache<Table, Policy>::RenumberSlots(int vertexIndex, const std::vector<int>& removedSlots)
+{
+    std::vector<RouteKey> keys;
+    RoutesOf(keys, vertexIndex);
+
+    std::vector<int> intArray;
+    for(size_t k = 0; k < keys.size(); k++)
+    {
+        intArray.clear();
+        table.Find(intArray, keys[k].startInt, keys[k].endInt, keys[k].signature);
+
+        bool usesRemoved = false, shifted = false;
+        for(size_t i = 0; i + 1 < intArray.size(); i += 2)
+        {
+            if(intArray[i] != vertexIndex) continue;
+
+            int slot = intArray[i + 1];
+            std::vector<int>::const_iterator it;
+            it = std::lower_bound(removedSlots.begin(), removedSlots.end(), slot);
+            if(it != removedSlots.end() && *it == slot) usesRemoved = true;
+            else if(it != removedSlots.begin())
+            {
+                intArray[i + 1] = slot - static_cast<int>(it - removedSlots.begin());
+                shifted = true;
+            }
+        }
+
+        if(usesRemoved)
+        {
+            Evict(keys[k].startInt, keys[k].endInt, keys[k].signature);
+        }
+        else if(shifted)
+        {
+            // Same vertices, the reverse index does not change
+            std::vector<int> old;
+            table.Remove(old, keys[k].startInt, keys[k].endInt, keys[k].signature);
+            table.Insert(intArray, keys[k].signature);
+        }
+    }
+}
+
+template<class Table, class Policy>
+int RouteCache<Table, Policy>::Insert(const std::vector<int>& intArray, const QuerySignature& signature)
+{
+    if(intArray.size() < 1) throw InvalidTableArgException();
+
+    RouteKey key = {intArray[0], intArray[intArray.size() - 1], signature};
+    std::unordered_map<RouteKey, int, RouteKeyHash>::iterator it = handles.find(key);
+    if(it != handles.end())
+    {
+        policy.Touch(it->second);
+        return table.Insert(intArray, signature);
+    }
+
+    if(capacity > 0 && routeCount >= capacity) EvictVictim();
+
+    // A fixed size table may still be full (it has its own threshold)
+    int result;
+    for(;;)
+    {
+        try
+        {
+            result = table.Insert(intArray, signature);
+            break;
+        }
+        catch(TableCapFullException&)
+        {
+            if(!EvictVictim()) throw;
+        }
+    }
+
+    IndexRoute(intArray, signature);
+    policy.Insert(AcquireHandle(key));
+    routeCount++;
+    return result;
+}
+
+template<class Table, class Policy>
+bool RouteCache<Table, Policy>::Find(std::vector<int>& intArray,
+                                     int startInt, int endInt, const QuerySignature& signature,
+                                     bool incLRU)
+{
+    if(!table.Find(intArray, startInt, endInt, signature, incLRU)) return false;
+
+    if(incLRU)
+    {
+        RouteKey key = {startInt, endInt, signature};
+        policy.Touch(handles[key]);
+    }
+    return true;
+}
+
+template<class Table, class Policy>
+bool RouteCache<Table, Policy>::FindSubpath(std::vector<int>& intArray,
+                                            int startInt, int endInt, const QuerySignature& signature,
+                                            bool incLRU)
+{
+    int indexSize = static_cast<int>(vertexRoutes.size());
+    if(startInt < 0 || endInt < 0 || startInt >= indexSize || endInt >= indexSize)
+        return false;
+
+    // A hub has many routes through it, its spoke only a few
+    const std::vector<RouteKey>& startRoutes = vertexRoutes[startInt];
+    const std::vector<RouteKey>& endRoutes = vertexRoutes[endInt];
+    const std::vector<RouteKey>& candidates = (startRoutes.size() <= endRoutes.size())
+                                              ? startRoutes : endRoutes;
+
+    std::vector<int> route;
+    for(size_t k = 0; k < candidates.size(); k++)
+    {
+        const RouteKey& key = candidates[k];
+        if(key.signature != signature) continue;
+
+        route.clear();
+        table.Find(route, key.startInt, key.endInt, key.signature);
+
+        // Shortest paths are simple, a vertex is on the route once
+        size_t begin = route.size();
+        for(size_t i = 0; i < route.size(); i += 2)
+        {
+            if(begin == route.size())
+            {
+                if(route[i] != startInt) continue;
+                begin = i;
+            }
+            if(route[i] != endInt) continue;
+
+            if(incLRU) policy.Touch(handles[key]);
+            intArray.insert(intArray.end(), route.begin() + begin, route.begin() + i + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+template<class Table, class Policy>
+void RouteCache<Table, Policy>::Remove(int startInt, int endInt, const QuerySignature& signature)
+{
+    Evict(startInt, endInt, signature);
+}
+
+template<class Table, class Policy>
+void RouteCache<Table, Policy>::RemoveLRU(int lruElementCount)
+{
+    while(lruElementCount-- > 0 && EvictVictim());
+}
+
+template<class Table, class Policy>
+void RouteCache<Table, Policy>::InvalidateTable()
+{
+    table.InvalidateTable();
+    policy.Clear();
+    vertexRoutes.clear();
+    handles.clear();
+    handleKeys.clear();
+    freeHandles.clear();
+    routeCount = 0;
+    trees.Clear();
+}
+
+template<class Table, class Policy>
+int RouteCache<Table, Policy>::RouteCount() const
+{
+    return routeCount;
+}
+
+template<class Table, class Policy>
+int RouteCache<Table, Policy>::Capacity() const
+{
+    return capacity;
+}
+
+template<class Table, class Policy>
+bool RouteCache<Table, Policy>::Search(const MultiGraph& graph,
+                                       std::vector<int>& orderedVertexEdgeIndexList,
+                                       const std::string& vertexNameFrom,
+                                       const std::string& vertexNameTo,
+                                       const QuerySignature& signature,
+                                       const std::vector<std::string>& edgeNames)
+{
+    // Searched on the quantized blend so that every query sharing the
+    // signature gets the same (optimal) route
+    float blend = signature.Blend();
+    switch(signature.kind)
+    {
+        case QUERY_FILTERED:
+            return graph.FilteredShortestPath(orderedVertexEdgeIndexList,
+                                              vertexNameFrom, vertexNameTo,
+                                              blend, edgeNames);
+        case QUERY_BIDIRECTIONAL:
+            return graph.BiDirectionalShortestPath(orderedVertexEdgeIndexList,
+                                                   vertexNameFrom, vertexNameTo,
+                                                   blend, edgeNames);
+        default:
+            return graph.HeuristicShortestPath(orderedVertexEdgeIndexList,
+                                               vertexNameFrom, vertexNameTo, blend);
+    }
+}
+
+template<class Table, class Policy>
+bool RouteCache<Table, Policy>::Query(std::vector<int>& orderedVertexEdgeIndexList,
+                                      const std::string& vertexNameFrom,
+                                      const std::string& vertexNameTo,
+                                      const QuerySignature& signature,
+                                      const std::vector<std::string>& edgeNames)
+{
+    int fromIndex = graph.FindVertexIndex(vertexNameFrom);
+    int toIndex = graph.FindVertexIndex(vertexNameTo);
+
+    if(fromIndex == -1) throw VertexNotFoundException(vertexNameFrom);
+    if(toIndex == -1) throw VertexNotFoundException(vertexNameTo);
+
+    if(Find(orderedVertexEdgeIndexList, fromIndex, toIndex, signature, true))
+        return true;
+
+    // A tree answers unreachable pairs too
+    const ShortestPathTree* tree = trees.Find(fromIndex, signature);
+    if(tree) return tree->ExtractPath(orderedVertexEdgeIndexList, toIndex);
+
+    if(FindSubpath(orderedVertexEdgeIndexList, fromIndex, toIndex, signature, true))
+        return true;
+
+    if(trees.Admit(fromIndex, signature))
+    {
+        tree = trees.Insert(graph, vertexNameFrom, signature, edgeNames);
+        if(tree) return tree->ExtractPath(orderedVertexEdgeIndexList, toIndex);
+    }
+
+    // Unreachable pairs are not cached
+    std::vector<int> path;
+    if(!Search(graph, path, vertexNameFrom, vertexNameTo, signature, edgeNames))
+        return false;
+
+    Insert(path, signature);
+
+    orderedVertexEdgeIndexList.insert(orderedVertexEdgeIndexList.end(),
+                                      path.begin(), path.end());
+    return true;
+}
+
+template<class Table, class Policy>
+bool RouteCache<Table, Policy>::ShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                             const std::string& vertexNameFrom,
+                                             const std::string& vertexNameTo,
+                                             bool isCostWeighted)
+{
+    return Query(orderedVertexEdgeIndexList, vertexNameFrom, vertexNameTo,
+                 QuerySignature(isCostWeighted), std::vector<std::string>());
+}
+
+template<class Table, class Policy>
+bool RouteCache<Table, Policy>::HeuristicShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                                      const std::string& vertexNameFrom,
+                                                      const std::string& vertexNameTo,
+                                                      float heuristicWeight)
+{
+    std::vector<std::string> noFilter;
+    return Query(orderedVertexEdgeIndexList, vertexNameFrom, vertexNameTo,
+                 QuerySignature::Make(QUERY_HEURISTIC, heuristicWeight, noFilter), noFilter);
+}
+
+template<class Table, class Policy>
+bool RouteCache<Table, Policy>::FilteredShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                                     const std::string& vertexNameFrom,
+                                                     const std::string& vertexNameTo,
+                                                     float heuristicWeight,
+                                                     const std::vector<std::string>& edgeNames)
+{
+    return Query(orderedVertexEdgeIndexList, vertexNameFrom, vertexNameTo,
+                 QuerySignature::Make(QUERY_FILTERED, heuristicWeight, edgeNames), edgeNames);
+}
+
+template<class Table, class Policy>
+bool RouteCache<Table, Policy>::BiDirectionalShortestPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                                          const std::string& vertexNameFrom,
+                                                          const std::string& vertexNameTo,
+                                                          float heuristicWeight,
+                                                          const std::vector<std::string>& edgeNames)
+{
+    return Query(orderedVertexEdgeIndexList, vertexNameFrom, vertexNameTo,
+                 QuerySignature::Make(QUERY_BIDIRECTIONAL, heuristicWeight, edgeNames), edgeNames);
+}
+
+template<class Table, class Policy>
+void RouteCache<Table, Policy>::InsertVertex(const std::string& vertexName)
+{
+    // An isolated vertex can not change any route
+    graph.InsertVertex(vertexName);
+}
+
+template<class Table, class Policy>
+void RouteCache<Table, Policy>::RemoveVertex(const std::string& vertexName)
+{
+    int removedIndex = graph.FindVertexIndex(vertexName);
+    if(removedIndex == -1)
+    {
+        // Throws
+        graph.RemoveVertex(vertexName);
+        return;
+    }
+
+    // Slots of the in-neighbours that will be removed (sorted per vertex)
+    std::vector<std::pair<int, int> > inSlots;
+    const std::vector<GraphInEdge>& inEdges = graph.vertexList[removedIndex].inEdges;
+    for(size_t i = 0; i < inEdges.size(); i++)
+    {
+        if(inEdges[i].startVertexIndex == removedIndex) continue;
+        inSlots.push_back(std::make_pair(inEdges[i].startVertexIndex, inEdges[i].edgeSlot));
+    }
+    std::sort(inSlots.begin(), inSlots.end());
+
+    graph.RemoveVertex(vertexName);
+    trees.RemoveVertex(removedIndex, inSlots);
+
+    std::vector<RouteKey> keys;
+    RoutesOf(keys, removedIndex);
+    for(size_t k = 0; k < keys.size(); k++)
+        Evict(keys[k].startInt, keys[k].endInt, keys[k].signature);
+
+    std::vector<int> removedSlots;
+    for(size_t i = 0; i < inSlots.size(); i++)
+    {
+        removedSlots.push_back(inSlots[i].second);
+        if(i + 1 == inSlots.size() || inSlots[i + 1].first != inSlots[i].first)
+        {
+            RenumberSlots(inSlots[i].first, removedSlots);
+            removedSlots.clear();
+        }
+    }
+}
+
+template<class Table, class Policy>
+void RouteCache<Table, Policy>::AddEdge(const std::string& edgeName,
+                                           const std::string& vertexFromName,
+                                           const std::string& vertexToName,
+                                           float weight0, float weight1)
+{
+    int u = graph.FindVertexIndex(vertexFromName);
+    int v = graph.FindVertexIndex(vertexToName);
+    if(u == -1 || v == -1 || graph.FindEdgeSlot(u, edgeName, v) != -1)
+    {
+        // Throws
+        graph.AddEdge(edgeName, vertexFromName, vertexToName, weight0, weight1);
+        return;
+    }
+
+    // Bounds are read before the edit (AddEdge drops the landmark tables).
+    // Routes visiting "u" or "v" are found on the reverse index.
+    std::vector<RouteKey> improvable;
+    std::unordered_set<RouteKey, RouteKeyHash> visiting;
+    std::vector<RouteKey> keys;
+    std::vector<int> intArray;
+    for(int side = 0; side < 2; side++)
+    {
+        RoutesOf(keys, side == 0 ? u : v);
+        for(size_t k = 0; k < keys.size(); k++)
+        {
+            if(!visiting.insert(keys[k]).second) continue;
+
+            intArray.clear();
+            table.Find(intArray, keys[k].startInt, keys[k].endInt, keys[k].signature);
+            float alpha = keys[k].signature.Blend();
+            if(MayImprove(intArray, alpha, u, v, MultiGraph::Lerp(weight0, weight1, alpha)))
+                improvable.push_back(keys[k]);
+        }
+    }
+
+    // The other routes only have lower bounds on both sides, they are
+    // tested if their blend has landmark tables and evicted otherwise
+    // (the test would be w < D)
+    if(graph.landmarkTables.empty())
+    {
+        // Every route is listed under its start vertex
+        for(size_t i = 0; i < vertexRoutes.size(); i++)
+            for(size_t k = 0; k < vertexRoutes[i].size(); k++)
+            {
+                const RouteKey& key = vertexRoutes[i][k];
+                if(key.startInt == static_cast<int>(i) && !visiting.count(key))
+                    improvable.push_back(key);
+            }
+    }
+    else
+    {
+        table.ForEach([&](const HashData& data)
+        {
+            RouteKey key = {data.startInt, data.endInt, data.signature};
+            if(visiting.count(key)) return;
+
+            float alpha = data.signature.Blend();
+            if(!graph.HasLandmarks(alpha) ||
+               MayImprove(data.intArray, alpha, u, v, MultiGraph::Lerp(weight0, weight1, alpha)))
+                improvable.push_back(key);
+        });
+    }
+
+    graph.AddEdge(edgeName, vertexFromName, vertexToName, weight0, weight1);
+    trees.AddEdge(u, v, edgeName, weight0, weight1);
+
+    for(size_t k = 0; k < improvable.size(); k++)
+        Evict(improvable[k].startInt, improvable[k].endInt, improvable[k].signature);
+}
+
+template<class Table, class Policy>
+void RouteCache<Table, Policy>::RemoveEdge(const std::string& edgeName,
+                                              const std::string& vertexFromName,
+                                              const std::string& vertexToName)
+{
+    int u = graph.FindVertexIndex(vertexFromName);
+    int v = graph.FindVertexIndex(vertexToName);
+    int slot = (u == -1 || v == -1) ? -1 : graph.FindEdgeSlot(u, edgeName, v);
+
+    // Throws if the edge is not there
+    graph.RemoveEdge(edgeName, vertexFromName, vertexToName);
+    trees.RemoveEdge(u, slot);
+
+    RenumberSlots(u, std::vector<int>(1, slot));
+}
+
+template<class Table, class Policy>
+void RouteCache<Table, Policy>::Compact()
+{
+    std::vector<int> newIndices;
+    graph.Compact(&newIndices);
+
+    bool renumbered = false;
+    for(size_t i = 0; i < newIndices.size() && !renumbered; i++)
+        renumbered = (newIndices[i] != static_cast<int>(i));
+    if(!renumbered) return;
+
+    trees.Compact(newIndices);
+
+    // Every route is renumbered, handles (and the policy state) are kept
+    std::vector<std::pair<std::vector<int>, QuerySignature> > routes;
+    table.ForEach([&routes](const HashData& data)
+    {
+        routes.push_back(std::make_pair(data.intArray, data.signature));
+    });
+
+    std::unordered_map<RouteKey, int, RouteKeyHash> oldHandles;
+    oldHandles.swap(handles);
+    table.InvalidateTable();
+    vertexRoutes.clear();
+    for(size_t r = 0; r < routes.size(); r++)
+    {
+        std::vector<int>& route = routes[r].first;
+        const QuerySignature& signature = routes[r].second;
+        RouteKey oldKey = {route[0], route[route.size() - 1], signature};
+        int handle = oldHandles[oldKey];
+
+        bool removed = false;
+        for(size_t i = 0; i < route.size(); i += 2)
+        {
+            route[i] = newIndices[route[i]];
+            removed = removed || route[i] == -1;
+        }
+
+        if(removed)
+        {
+            policy.Remove(handle);
+            freeHandles.push_back(handle);
+            routeCount--;
+            continue;
+        }
+
+        RouteKey key = {route[0], route[route.size() - 1], signature};
+        table.Insert(route, signature);
+        IndexRoute(route, signature);
+        handles[key] = handle;
+        handleKeys[handle] = key;
+    }
+}
+
+#endif // ROUTE_CACHE_HPP
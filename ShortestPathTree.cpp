@@ -0,0 +1,68 @@
+#include "ShortestPathTree.h"
+#include <cstddef>
+#include <limits>
+
+ShortestPathTree::ShortestPathTree()
+    : sourceIndex(-1)
+    , heuristicWeight(0)
+{}
+
+int ShortestPathTree::SourceIndex() const
+{
+    return sourceIndex;
+}
+
+float ShortestPathTree::HeuristicWeight() const
+{
+    return heuristicWeight;
+}
+
+int ShortestPathTree::VertexCount() const
+{
+    return static_cast<int>(distance.size());
+}
+
+bool ShortestPathTree::IsReachable(int vertexIndex) const
+{
+    return vertexIndex < VertexCount() &&
+           distance[vertexIndex] < std::numeric_limits<float>::infinity();
+}
+
+float ShortestPathTree::Distance(int vertexIndex) const
+{
+    return distance[vertexIndex];
+}
+
+int ShortestPathTree::PreviousVertex(int vertexIndex) const
+{
+    return previous[vertexIndex];
+}
+
+int ShortestPathTree::PreviousEdge(int vertexIndex) const
+{
+    return previousEdge[vertexIndex];
+}
+
+bool ShortestPathTree::ExtractPath(std::vector<int>& orderedVertexEdgeIndexList,
+                                   int vertexIndex) const
+{
+    if(sourceIndex == -1 || !IsReachable(vertexIndex)) return false;
+
+    // Count the hops first, then fill the list from its end
+    int hops = 0;
+    for(int curr = vertexIndex; curr != sourceIndex; curr = previous[curr])
+        hops++;
+
+    size_t begin = orderedVertexEdgeIndexList.size();
+    orderedVertexEdgeIndexList.resize(begin + 2 * hops + 1);
+
+    size_t i = begin + 2 * hops;
+    for(int curr = vertexIndex; curr != sourceIndex; curr = previous[curr])
+    {
+        orderedVertexEdgeIndexList[i] = curr;
+        orderedVertexEdgeIndexList[i - 1] = previousEdge[curr];
+        i -= 2;
+    }
+    orderedVertexEdgeIndexList[begin] = sourceIndex;
+    return true;
+}
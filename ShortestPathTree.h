@@ -0,0 +1,46 @@
+#ifndef SHORTEST_PATH_TREE_H
+#define SHORTEST_PATH_TREE_H
+
+#include <vector>
+
+// One-to-all shortest path result of a MultiGraph search
+// (see MultiGraph::ShortestPathTreeFrom).
+//
+// Holds distance, predecessor vertex and predecessor edge slot of every
+// vertex, so a path to any destination is extracted in O(path length)
+// without searching again. The object can be reused for another search,
+// its storage is kept.
+class ShortestPathTree
+{
+    friend class MultiGraph;
+    friend class ShortestPathTreeCache;
+
+    private:
+    int                 sourceIndex;
+    float               heuristicWeight;
+    std::vector<float>  distance;
+    std::vector<int>    previous;       // Predecessor vertex
+    std::vector<int>    previousEdge;   // Edge slot on the predecessor
+
+    protected:
+    public:
+    // Constructors & Destructor
+                ShortestPathTree();
+
+    int         SourceIndex() const;
+    float       HeuristicWeight() const;
+    int         VertexCount() const;
+
+    // Vertices added to the graph after the search are not reachable
+    bool        IsReachable(int vertexIndex) const;
+    float       Distance(int vertexIndex) const;
+    int         PreviousVertex(int vertexIndex) const;
+    int         PreviousEdge(int vertexIndex) const;
+
+    // Appends the path (same format as MultiGraph shortest path functions)
+    // returns false if the vertex is not reachable
+    bool        ExtractPath(std::vector<int>& orderedVertexEdgeIndexList,
+                            int vertexIndex) const;
+};
+
+#endif // SHORTEST_PATH_TREE_H
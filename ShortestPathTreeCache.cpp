@@ -0,0 +1,294 @@
+#include "ShortestPathTreeCache.h"
+#include "MultiGraph.h"
+#include "Exceptions.h"
+#include <algorithm>
+#include <limits>
+
+ShortestPathTreeCache::ShortestPathTreeCache(size_t memoryBudget)
+    : memoryBudget(memoryBudget)
+    , memoryUsage(0)
+    , missCounters(MISS_COUNTER_COUNT, 0)
+    , admitCalls(0)
+{}
+
+TreeKey ShortestPathTreeCache::MakeKey(int sourceIndex, const QuerySignature& signature)
+{
+    TreeKey key = {sourceIndex, signature.filterHash, signature.blend};
+    return key;
+}
+
+size_t ShortestPathTreeCache::EntryBytes(const Entry& entry)
+{
+    size_t bytes = sizeof(Entry) +
+                   entry.tree.VertexCount() * (sizeof(float) + 2 * sizeof(int));
+    for(size_t i = 0; i < entry.edgeNames.size(); i++)
+        bytes += sizeof(std::string) + entry.edgeNames[i].size();
+    return bytes;
+}
+
+void ShortestPathTreeCache::Drop(int handle, bool isVictim)
+{
+    handles.erase(entries[handle].key);
+    Release(handle, isVictim);
+}
+
+void ShortestPathTreeCache::Release(int handle, bool isVictim)
+{
+    Entry& entry = entries[handle];
+    if(!isVictim) policy.Remove(handle);
+    memoryUsage -= entry.bytes;
+
+    // Storage is released, a freed handle only keeps the Entry
+    entry.tree = ShortestPathTree();
+    std::vector<std::string>().swap(entry.edgeNames);
+    entry.bytes = 0;
+    freeHandles.push_back(handle);
+}
+
+bool ShortestPathTreeCache::RenumberSlots(ShortestPathTree& tree, int vertexIndex,
+                                          const std::vector<int>& removedSlots)
+{
+    for(int i = 0; i < tree.VertexCount(); i++)
+    {
+        if(tree.previous[i] != vertexIndex) continue;
+
+        int slot = tree.previousEdge[i];
+        std::vector<int>::const_iterator it;
+        it = std::lower_bound(removedSlots.begin(), removedSlots.end(), slot);
+        if(it != removedSlots.end() && *it == slot) return false;
+        tree.previousEdge[i] = slot - static_cast<int>(it - removedSlots.begin());
+    }
+    return true;
+}
+
+const ShortestPathTree* ShortestPathTreeCache::Find(int sourceIndex, const QuerySignature& signature)
+{
+    std::unordered_map<TreeKey, int, TreeKeyHash>::const_iterator it;
+    it = handles.find(MakeKey(sourceIndex, signature));
+    if(it == handles.end()) return NULL;
+
+    policy.Touch(it->second);
+    return &entries[it->second].tree;
+}
+
+bool ShortestPathTreeCache::Admit(int sourceIndex, const QuerySignature& signature)
+{
+    if(memoryBudget == 0) return false;
+
+    if(++admitCalls == AGING_PERIOD)
+    {
+        for(int i = 0; i < MISS_COUNTER_COUNT; i++) missCounters[i] >>= 1;
+        admitCalls = 0;
+    }
+
+    unsigned char& counter = missCounters[TreeKeyHash()(MakeKey(sourceIndex, signature)) &
+                                          (MISS_COUNTER_COUNT - 1)];
+    if(++counter < ADMISSION_MISSES) return false;
+
+    counter = 0;
+    return true;
+}
+
+const ShortestPathTree* ShortestPathTreeCache::Insert(const MultiGraph& graph,
+                                                      const std::string& vertexNameFrom,
+                                                      const QuerySignature& signature,
+                                                      const std::vector<std::string>& edgeNames)
+{
+    int sourceIndex = graph.FindVertexIndex(vertexNameFrom);
+    if(sourceIndex == -1) throw VertexNotFoundException(vertexNameFrom);
+
+    TreeKey key = MakeKey(sourceIndex, signature);
+    std::unordered_map<TreeKey, int, TreeKeyHash>::const_iterator it = handles.find(key);
+    if(it != handles.end())
+    {
+        policy.Touch(it->second);
+        return &entries[it->second].tree;
+    }
+
+    // Size is known before the search
+    Entry entry;
+    entry.key = key;
+    entry.edgeNames = edgeNames;
+    std::sort(entry.edgeNames.begin(), entry.edgeNames.end());
+    entry.edgeNames.erase(std::unique(entry.edgeNames.begin(), entry.edgeNames.end()),
+                          entry.edgeNames.end());
+    entry.bytes = EntryBytes(entry) +
+                  graph.vertexList.size() * (sizeof(float) + 2 * sizeof(int));
+    if(entry.bytes > memoryBudget) return NULL;
+
+    while(memoryUsage + entry.bytes > memoryBudget)
+    {
+        int victim = policy.Victim();
+        if(victim == -1) break;
+        Drop(victim, true);
+    }
+
+    graph.FilteredShortestPathTreeFrom(entry.tree, vertexNameFrom,
+                                       signature.Blend(), edgeNames);
+
+    int handle;
+    if(freeHandles.empty())
+    {
+        handle = static_cast<int>(entries.size());
+        entries.push_back(Entry());
+    }
+    else
+    {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    std::swap(entries[handle], entry);
+
+    handles[key] = handle;
+    policy.Insert(handle);
+    memoryUsage += entries[handle].bytes;
+    return &entries[handle].tree;
+}
+
+void ShortestPathTreeCache::Clear()
+{
+    entries.clear();
+    freeHandles.clear();
+    handles.clear();
+    policy.Clear();
+    memoryUsage = 0;
+}
+
+void ShortestPathTreeCache::AddEdge(int vertexFromIndex, int vertexToIndex,
+                                    const std::string& edgeName,
+                                    float weight0, float weight1)
+{
+    const float INF = std::numeric_limits<float>::infinity();
+
+    std::vector<int> improved;
+    std::unordered_map<TreeKey, int, TreeKeyHash>::const_iterator it;
+    for(it = handles.begin(); it != handles.end(); ++it)
+    {
+        const Entry& entry = entries[it->second];
+        const ShortestPathTree& tree = entry.tree;
+        if(!tree.IsReachable(vertexFromIndex)) continue;
+        if(std::binary_search(entry.edgeNames.begin(), entry.edgeNames.end(), edgeName))
+            continue;
+
+        // Same relaxation as the search
+        float B = MultiGraph::Lerp(weight0, weight1, tree.HeuristicWeight());
+        float toV = (vertexToIndex < tree.VertexCount()) ? tree.Distance(vertexToIndex) : INF;
+        if(tree.Distance(vertexFromIndex) + B < toV) improved.push_back(it->second);
+    }
+
+    for(size_t i = 0; i < improved.size(); i++) Drop(improved[i], false);
+}
+
+void ShortestPathTreeCache::RemoveEdge(int vertexFromIndex, int edgeSlot)
+{
+    std::vector<int> removedSlots(1, edgeSlot);
+    std::vector<int> used;
+    std::unordered_map<TreeKey, int, TreeKeyHash>::const_iterator it;
+    for(it = handles.begin(); it != handles.end(); ++it)
+    {
+        if(!RenumberSlots(entries[it->second].tree, vertexFromIndex, removedSlots))
+            used.push_back(it->second);
+    }
+
+    // Removing an edge that is not on the tree changes no distance
+    for(size_t i = 0; i < used.size(); i++) Drop(used[i], false);
+}
+
+void ShortestPathTreeCache::RemoveVertex(int vertexIndex,
+                                         const std::vector<std::pair<int, int> >& inSlots)
+{
+    std::vector<int> affected;
+    std::vector<int> removedSlots;
+    std::unordered_map<TreeKey, int, TreeKeyHash>::const_iterator it;
+    for(it = handles.begin(); it != handles.end(); ++it)
+    {
+        ShortestPathTree& tree = entries[it->second].tree;
+        if(tree.IsReachable(vertexIndex))
+        {
+            affected.push_back(it->second);
+            continue;
+        }
+
+        // Edges to an unreachable vertex are not on the tree
+        for(size_t i = 0; i < inSlots.size(); i++)
+        {
+            removedSlots.push_back(inSlots[i].second);
+            if(i + 1 == inSlots.size() || inSlots[i + 1].first != inSlots[i].first)
+            {
+                RenumberSlots(tree, inSlots[i].first, removedSlots);
+                removedSlots.clear();
+            }
+        }
+    }
+
+    for(size_t i = 0; i < affected.size(); i++) Drop(affected[i], false);
+}
+
+void ShortestPathTreeCache::Compact(const std::vector<int>& newIndices)
+{
+    // Keys change with the source, the map is rebuilt
+    std::unordered_map<TreeKey, int, TreeKeyHash> oldHandles;
+    oldHandles.swap(handles);
+
+    std::unordered_map<TreeKey, int, TreeKeyHash>::const_iterator it;
+    for(it = oldHandles.begin(); it != oldHandles.end(); ++it)
+    {
+        Entry& entry = entries[it->second];
+        ShortestPathTree& tree = entry.tree;
+
+        // Renumbering keeps the order, vertices of the tree stay a prefix.
+        // Edge slots do not change (edges to a tombstone were removed
+        // with it).
+        bool valid = newIndices[tree.sourceIndex] != -1;
+        int size = 0;
+        for(int i = 0; i < tree.VertexCount() && valid; i++)
+        {
+            int n = newIndices[i];
+            if(n == -1)
+            {
+                valid = !tree.IsReachable(i);
+                continue;
+            }
+
+            int prev = tree.previous[i];
+            tree.distance[n] = tree.distance[i];
+            tree.previous[n] = (prev == -1) ? -1 : newIndices[prev];
+            tree.previousEdge[n] = tree.previousEdge[i];
+            size = n + 1;
+        }
+
+        if(!valid)
+        {
+            // Not on the map anymore, its old key may already belong to
+            // a renumbered tree
+            Release(it->second, false);
+            continue;
+        }
+
+        tree.distance.resize(size);
+        tree.previous.resize(size);
+        tree.previousEdge.resize(size);
+        tree.sourceIndex = newIndices[tree.sourceIndex];
+        entry.key.sourceIndex = tree.sourceIndex;
+        handles[entry.key] = it->second;
+
+        memoryUsage -= entry.bytes;
+        entry.bytes = EntryBytes(entry);
+        memoryUsage += entry.bytes;
+    }
+}
+
+int ShortestPathTreeCache::TreeCount() const
+{
+    return static_cast<int>(handles.size());
+}
+
+size_t ShortestPathTreeCache::MemoryUsage() const
+{
+    return memoryUsage;
+}
+
+size_t ShortestPathTreeCache::MemoryBudget() const
+{
+    return memoryBudget;
+}
@@ -0,0 +1,139 @@
+#ifndef SHORTEST_PATH_TREE_CACHE_H
+#define SHORTEST_PATH_TREE_CACHE_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <unordered_map>
+#include "ShortestPathTree.h"
+#include "QuerySignature.h"
+#include "EvictionPolicy.h"
+
+class MultiGraph;
+
+// Key of a cached tree, every query kind of the same blend and excluded
+// edge set has the same distances so the kind is not a part of it
+struct TreeKey
+{
+    int                 sourceIndex;
+    unsigned long long  filterHash;
+    unsigned short      blend;
+
+    bool operator==(const TreeKey& other) const
+    {
+        return sourceIndex == other.sourceIndex && blend == other.blend &&
+               filterHash == other.filterHash;
+    }
+};
+
+struct TreeKeyHash
+{
+    size_t operator()(const TreeKey& key) const
+    {
+        unsigned long long h = static_cast<unsigned int>(key.sourceIndex);
+        h = h * 0x9E3779B97F4A7C15ull + key.filterHash;
+        h = h * 0x9E3779B97F4A7C15ull + key.blend;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+};
+
+// Shortest path trees of the busiest sources, a tier of the route cache
+// (see RouteCache).
+//
+// A tree (ShortestPathTree, 12 bytes per vertex) answers a query from
+// its source to any destination with a walk of the path, so a source
+// asked about many destinations is searched once. Trees are built for a
+// (source, QuerySignature) only on its ADMISSION_MISSES'th miss, one off
+// sources keep using point to point searches (a one-to-all search costs
+// a few of them). Miss counters are hashed bytes that are halved every
+// AGING_PERIOD calls of Admit.
+//
+// Memory of the trees is bounded by "memoryBudget" bytes, least
+// recently used trees are evicted to make room (a tree larger than the
+// budget is not cached).
+//
+// Graph edits are applied as on the routes, with exact tests since
+// every distance from the source is known:
+//
+// AddEdge      : a tree is evicted if the new edge u -> v (cost w) is
+//                not excluded by its filter and d(u) + w < d(v).
+// RemoveEdge   : a tree is evicted if the edge is one of its edges,
+//                later slots of the same vertex are renumbered.
+// RemoveVertex : a tree is evicted if the vertex is reachable from its
+//                source, slots of the in-neighbours are renumbered.
+// Compact      : trees are renumbered.
+// Vertices inserted after a search are unreachable on its tree.
+class ShortestPathTreeCache
+{
+    private:
+    static const int    ADMISSION_MISSES = 2;
+    static const int    MISS_COUNTER_COUNT = 4096;
+    static const int    AGING_PERIOD = 4 * MISS_COUNTER_COUNT;
+
+    struct Entry
+    {
+        TreeKey                     key;
+        ShortestPathTree            tree;
+        // Sorted excluded edge names
+        std::vector<std::string>    edgeNames;
+        size_t                      bytes;
+    };
+
+    size_t                          memoryBudget;
+    size_t                          memoryUsage;
+    // Entries by handle (freed handles are reused)
+    std::vector<Entry>              entries;
+    std::vector<int>                freeHandles;
+    std::unordered_map<TreeKey, int, TreeKeyHash> handles;
+    LRUPolicy                       policy;
+    std::vector<unsigned char>      missCounters;
+    int                             admitCalls;
+
+    static TreeKey MakeKey(int sourceIndex, const QuerySignature& signature);
+    static size_t  EntryBytes(const Entry& entry);
+
+    void        Drop(int handle, bool isVictim);
+    // Frees the entry of a handle that is not on "handles"
+    void        Release(int handle, bool isVictim);
+    // Shifts edge slots of the tree edges leaving "vertexIndex",
+    // "removedSlots" is sorted (old slots of the removed edges), returns
+    // false if the tree uses a removed edge
+    static bool RenumberSlots(ShortestPathTree& tree, int vertexIndex,
+                              const std::vector<int>& removedSlots);
+
+    protected:
+    public:
+    // Constructors & Destructor
+    explicit    ShortestPathTreeCache(size_t memoryBudget = 0);
+
+    // Tree of the source for the signature (NULL if not cached),
+    // the tree is touched on the policy
+    const ShortestPathTree* Find(int sourceIndex, const QuerySignature& signature);
+    // Counts a miss of the source, true if a tree should be built
+    bool        Admit(int sourceIndex, const QuerySignature& signature);
+    // Searches and caches the tree ("edgeNames" must match the signature),
+    // returns NULL if it does not fit the budget
+    const ShortestPathTree* Insert(const MultiGraph& graph,
+                                   const std::string& vertexNameFrom,
+                                   const QuerySignature& signature,
+                                   const std::vector<std::string>& edgeNames);
+    void        Clear();
+
+    // Graph edits (see above), called after the graph is edited
+    void        AddEdge(int vertexFromIndex, int vertexToIndex,
+                        const std::string& edgeName,
+                        float weight0, float weight1);
+    void        RemoveEdge(int vertexFromIndex, int edgeSlot);
+    // "inSlots" are (in-neighbour, old edge slot) pairs of the edges to
+    // the removed vertex, sorted
+    void        RemoveVertex(int vertexIndex,
+                             const std::vector<std::pair<int, int> >& inSlots);
+    // "newIndices" as given by MultiGraph::Compact
+    void        Compact(const std::vector<int>& newIndices);
+
+    int         TreeCount() const;
+    size_t      MemoryUsage() const;
+    size_t      MemoryBudget() const;
+};
+
+#endif // SHORTEST_PATH_TREE_CACHE_H
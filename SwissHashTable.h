@@ -0,0 +1,112 @@
+#ifndef SWISS_HASH_TABLE_H
+#define SWISS_HASH_TABLE_H
+
+#include <vector>
+#include <cstdio>
+#include "HashTable.h"
+
+// Fixed size route table with the interface of HashTable<MAX_SIZE>,
+// laid out as a swiss table.
+//
+// Keys are mixed to 64 bits (murmur3 finalizer) and folded to a 32 bit
+// tag kept on the slot. Every slot also has a control byte: EMPTY,
+// DELETED or the low 7 bits of its tag. Slots are probed in aligned
+// groups of GROUP_SIZE control bytes, compared at once (SSE2 if
+// available, a byte loop otherwise); only slots whose control byte
+// matches are compared further (tag, then the key on the arena). A
+// lookup ends at the first group with an empty slot, so a miss usually
+// reads one 16 byte group. Groups are probed triangularly, which visits
+// every group of a power of two count.
+//
+// Slots and routes are stored as on HashTable (HashSlot, PathArena,
+// records of RouteKeyPolicy).
+// Load is kept under 7/8 (MAX_LOAD) instead of 1/2, Insert throws
+// TableCapFullException beyond that. Removing a slot of a group that
+// has an empty slot makes it empty, otherwise it is marked DELETED.
+// Deleted slots are reused by Insert and purged (in place rehash) when
+// the used slots reach the limit, at most once every PURGE_COUNT
+// deletions (used slots may pass the limit by that much).
+//
+// "CAPACITY" is a power of two, at least GROUP_SIZE.
+template <int CAPACITY>
+class SwissHashTable
+{
+    private:
+    static const int            GROUP_SIZE = 16;
+    static const int            GROUP_COUNT = CAPACITY / GROUP_SIZE;
+    static const int            MAX_LOAD = CAPACITY - CAPACITY / 8;
+    static const int            PURGE_COUNT = (CAPACITY / 64 > 0) ? CAPACITY / 64 : 1;
+    static const unsigned char  CONTROL_EMPTY = 0x80;
+    static const unsigned char  CONTROL_DELETED = 0xFE;
+
+    // Record encoding and key comparison (its hash is not used)
+    typedef RouteKeyPolicy<>    RecordKey;
+
+    static_assert(CAPACITY >= GROUP_SIZE && (CAPACITY & (CAPACITY - 1)) == 0,
+                  "SwissHashTable capacity must be a power of two (at least 16)");
+
+    // Properties
+    alignas(16) unsigned char   control[CAPACITY];
+    HashSlot                    table[CAPACITY];
+    PathArena                   arena;
+    int                         elementCount;
+    int                         deletedCount;
+
+    // Private Members
+    static unsigned long long Mix(unsigned long long h);
+    static unsigned int Tag(int startInt, int endInt, const QuerySignature& signature);
+    static bool IsFull(unsigned char controlByte);
+    // Bit "i" is set if control byte "i" of the group is "value"
+    static unsigned int Match(const unsigned char* group, unsigned char value);
+    // Bit "i" is set if slot "i" of the group is empty or deleted
+    static unsigned int MatchFree(const unsigned char* group);
+
+    int         FindSlot(unsigned int tag,
+                         int startInt, int endInt, const QuerySignature& signature) const;
+    // First empty or deleted slot of the probe sequence
+    int         FreeSlot(unsigned int tag) const;
+    void        Vacate(int tableIndex);
+    // Route of the record of a slot (after its key)
+    const unsigned char* Route(int tableIndex) const;
+    size_t      RecordSize(int tableIndex) const;
+    // Rehashes in place, deleted slots become empty
+    void        PurgeDeleted();
+    // Moves the live records to a new arena
+    void        CompactArena();
+    // Implemented Private Members
+    void        PrintLine(int tableIndex) const;
+
+    public:
+    // Constructors & Destructor
+                SwissHashTable();
+    // Member Functions
+    int         Insert(const std::vector<int>& intArray, const QuerySignature& signature);
+    bool        Find(std::vector<int>& intArray,
+                     int startInt, int endInt, const QuerySignature& signature,
+                     bool incLRU = false);
+    // Zero copy, "view" is valid until the table is modified
+    bool        Find(PathView& view,
+                     int startInt, int endInt, const QuerySignature& signature,
+                     bool incLRU = false);
+    void        Remove(std::vector<int>& intArray,
+                       int startInt, int endInt, const QuerySignature& signature);
+    void        RemoveLRU(int lruElementCount);
+
+    void        InvalidateTable();
+    // Calls "visit(const HashData&)" for every occupied entry
+    // (decoded to a temporary)
+    template<class Visitor>
+    void        ForEach(Visitor visit) const;
+    void        GetMostInserted(std::vector<int>& intArray) const;
+    void        PrintSortedLRUEntries() const;
+    void        PrintTable() const;
+
+    int         ElementCount() const;
+    // Slots, control bytes and arena in bytes
+    size_t      MemoryUsage() const;
+};
+
+// Template Implementation
+#include "SwissHashTableImpl.h"
+
+#endif // SWISS_HASH_TABLE_H
@@ -0,0 +1,409 @@
+#ifndef SWISS_HASH_TABLE_HPP
+#define SWISS_HASH_TABLE_HPP
+
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+template<int CAPACITY>
+SwissHashTable<CAPACITY>::SwissHashTable()
+    : elementCount(0)
+    , deletedCount(0)
+{
+    memset(control, CONTROL_EMPTY, CAPACITY);
+}
+
+template<int CAPACITY>
+unsigned long long SwissHashTable<CAPACITY>::Mix(unsigned long long h)
+{
+    // Murmur3 finalizer, every input bit affects every output bit
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+template<int CAPACITY>
+unsigned int SwissHashTable<CAPACITY>::Tag(int startInt, int endInt, const QuerySignature& signature)
+{
+    unsigned long long key = (static_cast<unsigned long long>(static_cast<unsigned int>(startInt)) << 32) |
+                             static_cast<unsigned int>(endInt);
+    unsigned long long rest = signature.filterHash +
+                              ((static_cast<unsigned long long>(signature.blend) << 8) | signature.kind);
+    unsigned long long h = Mix(key ^ Mix(rest));
+
+    // Low 7 bits are the control byte, the next ones pick the group
+    return static_cast<unsigned int>(h ^ (h >> 32));
+}
+
+template<int CAPACITY>
+bool SwissHashTable<CAPACITY>::IsFull(unsigned char controlByte)
+{
+    return controlByte < 0x80;
+}
+
+template<int CAPACITY>
+unsigned int SwissHashTable<CAPACITY>::Match(const unsigned char* group, unsigned char value)
+{
+#ifdef __SSE2__
+    __m128i bytes = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+    __m128i match = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(value)));
+    return static_cast<unsigned int>(_mm_movemask_epi8(match));
+#else
+    unsigned int mask = 0;
+    for(int i = 0; i < GROUP_SIZE; i++)
+    {
+        if(group[i] == value) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+template<int CAPACITY>
+unsigned int SwissHashTable<CAPACITY>::MatchFree(const unsigned char* group)
+{
+#ifdef __SSE2__
+    // Empty and deleted are the only control bytes with the high bit set
+    __m128i bytes = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<unsigned int>(_mm_movemask_epi8(bytes));
+#else
+    unsigned int mask = 0;
+    for(int i = 0; i < GROUP_SIZE; i++)
+    {
+        if(!IsFull(group[i])) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+template<int CAPACITY>
+int SwissHashTable<CAPACITY>::FindSlot(unsigned int tag,
+                                       int startInt, int endInt, const QuerySignature& signature) const
+{
+    RouteKey key = RecordKey::Of(startInt, endInt, signature);
+    unsigned char h2 = static_cast<unsigned char>(tag & 0x7F);
+    int group = (tag >> 7) & (GROUP_COUNT - 1);
+    for(int i = 1; i <= GROUP_COUNT; i++)
+    {
+        const unsigned char* bytes = control + group * GROUP_SIZE;
+        for(unsigned int match = Match(bytes, h2); match != 0; match &= match - 1)
+        {
+            int q = group * GROUP_SIZE + __builtin_ctz(match);
+            if(table[q].tag == tag &&
+               RecordKey::Matches(arena.Record(table[q].offset), Route(q), key))
+                return q;
+        }
+        if(Match(bytes, CONTROL_EMPTY) != 0) return -1;
+
+        group = (group + i) & (GROUP_COUNT - 1);
+    }
+    return -1;
+}
+
+template<int CAPACITY>
+int SwissHashTable<CAPACITY>::FreeSlot(unsigned int tag) const
+{
+    // Used slots stay under MAX_LOAD + PURGE_COUNT, there is always a
+    // free slot
+    int group = (tag >> 7) & (GROUP_COUNT - 1);
+    for(int i = 1; ; i++)
+    {
+        unsigned int free = MatchFree(control + group * GROUP_SIZE);
+        if(free != 0) return group * GROUP_SIZE + __builtin_ctz(free);
+
+        group = (group + i) & (GROUP_COUNT - 1);
+    }
+}
+
+template<int CAPACITY>
+const unsigned char* SwissHashTable<CAPACITY>::Route(int tableIndex) const
+{
+    const unsigned char* record = arena.Record(table[tableIndex].offset);
+    return record + RecordKey::EncodedSize(record);
+}
+
+template<int CAPACITY>
+size_t SwissHashTable<CAPACITY>::RecordSize(int tableIndex) const
+{
+    const unsigned char* route = Route(tableIndex);
+    return (route - arena.Record(table[tableIndex].offset)) + PathArena::RouteSize(route, table[tableIndex].length);
+}
+
+template<int CAPACITY>
+void SwissHashTable<CAPACITY>::Vacate(int tableIndex)
+{
+    arena.Release(RecordSize(tableIndex));
+
+    // Lookups stop at a group with an empty slot, none of them probes
+    // past this group
+    const unsigned char* group = control + (tableIndex & ~(GROUP_SIZE - 1));
+    if(Match(group, CONTROL_EMPTY) != 0)
+    {
+        control[tableIndex] = CONTROL_EMPTY;
+    }
+    else
+    {
+        control[tableIndex] = CONTROL_DELETED;
+        deletedCount++;
+    }
+}
+
+template<int CAPACITY>
+void SwissHashTable<CAPACITY>::PurgeDeleted()
+{
+    std::vector<HashSlot> entries;
+    entries.reserve(elementCount);
+    for(int i = 0; i < CAPACITY; i++)
+    {
+        if(IsFull(control[i])) entries.push_back(table[i]);
+    }
+
+    // Placement only depends on the tag
+    memset(control, CONTROL_EMPTY, CAPACITY);
+    deletedCount = 0;
+    for(size_t i = 0; i < entries.size(); i++)
+    {
+        int q = FreeSlot(entries[i].tag);
+        control[q] = static_cast<unsigned char>(entries[i].tag & 0x7F);
+        table[q] = entries[i];
+    }
+}
+
+template<int CAPACITY>
+void SwissHashTable<CAPACITY>::CompactArena()
+{
+    PathArena compacted;
+    for(int i = 0; i < CAPACITY; i++)
+    {
+        if(IsFull(control[i]))
+            table[i].offset = compacted.Append(arena, table[i].offset, RecordSize(i));
+    }
+    arena.Swap(compacted);
+}
+
+template<int CAPACITY>
+int SwissHashTable<CAPACITY>::Insert(const std::vector<int>& intArray, const QuerySignature& signature)
+{
+    if(intArray.size() < 1) throw InvalidTableArgException();
+
+    int startInt = intArray[0];
+    int endInt = intArray[intArray.size() - 1];
+    unsigned int tag = Tag(startInt, endInt, signature);
+
+    // Existing key, same as HashTable
+    int q = FindSlot(tag, startInt, endInt, signature);
+    if(q != -1)
+    {
+        int result = table[q].lruCounter;
+        table[q].lruCounter++;
+        return result;
+    }
+
+    if(elementCount >= MAX_LOAD) throw TableCapFullException(elementCount);
+
+    q = FreeSlot(tag);
+    if(control[q] == CONTROL_DELETED)
+    {
+        deletedCount--;
+    }
+    else if(elementCount + deletedCount >= MAX_LOAD && deletedCount >= PURGE_COUNT)
+    {
+        PurgeDeleted();
+        q = FreeSlot(tag);
+    }
+
+    // Offsets change, slots do not
+    if(arena.NeedsCompaction()) CompactArena();
+
+    unsigned char encoded[RecordKey::MAX_ENCODED_SIZE];
+    int encodedSize = RecordKey::Encode(encoded, RecordKey::Of(intArray, signature));
+
+    control[q] = static_cast<unsigned char>(tag & 0x7F);
+    table[q].tag = tag;
+    table[q].offset = arena.Append(encoded, encodedSize, intArray);
+    table[q].length = intArray.size();
+    table[q].lruCounter = 1;
+    elementCount++;
+    return 0;
+}
+
+template<int CAPACITY>
+bool SwissHashTable<CAPACITY>::Find(std::vector<int>& intArray,
+                                    int startInt, int endInt, const QuerySignature& signature,
+                                    bool incLRU)
+{
+    PathView view;
+    if(!Find(view, startInt, endInt, signature, incLRU)) return false;
+
+    view.AppendTo(intArray);
+    return true;
+}
+
+template<int CAPACITY>
+bool SwissHashTable<CAPACITY>::Find(PathView& view,
+                                    int startInt, int endInt, const QuerySignature& signature,
+                                    bool incLRU)
+{
+    int q = FindSlot(Tag(startInt, endInt, signature), startInt, endInt, signature);
+    if(q == -1) return false;
+
+    if(incLRU) table[q].lruCounter++;
+    view = PathArena::View(Route(q), table[q].length);
+    return true;
+}
+
+template<int CAPACITY>
+void SwissHashTable<CAPACITY>::Remove(std::vector<int>& intArray,
+                                      int startInt, int endInt, const QuerySignature& signature)
+{
+    int q = FindSlot(Tag(startInt, endInt, signature), startInt, endInt, signature);
+    if(q == -1) return;
+
+    PathArena::View(Route(q), table[q].length).AppendTo(intArray);
+    Vacate(q);
+    elementCount--;
+}
+
+template<int CAPACITY>
+void SwissHashTable<CAPACITY>::RemoveLRU(int lruElementCount)
+{
+    MinPairHeap<int, int> Heap;
+    for(int i = 0; i < CAPACITY; i++)
+    {
+        if(IsFull(control[i])) Heap.push(Pair<int, int> {table[i].lruCounter, i});
+    }
+
+    while(lruElementCount > 0 && !Heap.empty())
+    {
+        Vacate(Heap.top().value);
+
+        Heap.pop();
+        elementCount--;
+        lruElementCount--;
+    }
+}
+
+template<int CAPACITY>
+void SwissHashTable<CAPACITY>::InvalidateTable()
+{
+    memset(control, CONTROL_EMPTY, CAPACITY);
+    arena.Clear();
+    elementCount = 0;
+    deletedCount = 0;
+}
+
+template<int CAPACITY>
+template<class Visitor>
+void SwissHashTable<CAPACITY>::ForEach(Visitor visit) const
+{
+    HashData data;
+    data.sentinel = OCCUPIED_MARK;
+    for(int i = 0; i < CAPACITY; i++)
+    {
+        if(!IsFull(control[i])) continue;
+
+        const unsigned char* route = Route(i);
+        RecordKey::Decode(arena.Record(table[i].offset), route, data);
+        data.intArray.clear();
+        PathArena::View(route, table[i].length).AppendTo(data.intArray);
+        data.lruCounter = table[i].lruCounter;
+        visit(data);
+    }
+}
+
+template<int CAPACITY>
+void SwissHashTable<CAPACITY>::GetMostInserted(std::vector<int>& intArray) const
+{
+    int most = -1;
+    for(int i = 0; i < CAPACITY; i++)
+    {
+        if(IsFull(control[i]) && (most == -1 || table[i].lruCounter > table[most].lruCounter))
+            most = i;
+    }
+
+    intArray.clear();
+    if(most != -1) PathArena::View(Route(most), table[most].length).AppendTo(intArray);
+}
+
+template<int CAPACITY>
+void SwissHashTable<CAPACITY>::PrintLine(int tableIndex) const
+{
+    // Using printf here it is easier to format
+    if(control[tableIndex] == CONTROL_DELETED)
+    {
+        printf("[%03d]         : DELETED\n", tableIndex);
+    }
+    else if(control[tableIndex] == CONTROL_EMPTY)
+    {
+        printf("[%03d]         : EMPTY\n", tableIndex);
+    }
+    else
+    {
+        HashData data;
+        const unsigned char* route = Route(tableIndex);
+        RecordKey::Decode(arena.Record(table[tableIndex].offset), route, data);
+        PathArena::View(route, table[tableIndex].length).AppendTo(data.intArray);
+
+        printf("[%03d] - [%03d] : ", tableIndex, table[tableIndex].lruCounter);
+        printf("(%d/%5.3f/%016llx) ", data.signature.kind,
+               data.signature.Blend(), data.signature.filterHash);
+        size_t sz = data.intArray.size();
+        for(size_t i = 0; i < sz; i++)
+        {
+            if(i % 2 == 0)
+                printf("[%03d]", data.intArray[i]);
+            else
+                printf("/%03d/", data.intArray[i]);
+
+            if(i != sz - 1)
+                printf("-->");
+        }
+        printf("\n");
+    }
+}
+
+template<int CAPACITY>
+void SwissHashTable<CAPACITY>::PrintSortedLRUEntries() const
+{
+    MaxPairHeap<int, int> Heap;
+    for(int i = 0; i < CAPACITY; i++)
+    {
+        if(IsFull(control[i])) Heap.push(Pair<int, int> {table[i].lruCounter, i});
+    }
+
+    while(!Heap.empty())
+    {
+        PrintLine(Heap.top().value);
+        Heap.pop();
+    }
+}
+
+template<int CAPACITY>
+void SwissHashTable<CAPACITY>::PrintTable() const
+{
+    printf("____________________\n");
+    printf("Elements %d (deleted %d)\n", elementCount, deletedCount);
+    printf("[IDX] - [LRU] | DATA\n");
+    printf("____________________\n");
+    for(int i = 0; i < CAPACITY; i++)
+    {
+        PrintLine(i);
+    }
+}
+
+template<int CAPACITY>
+int SwissHashTable<CAPACITY>::ElementCount() const
+{
+    return elementCount;
+}
+
+template<int CAPACITY>
+size_t SwissHashTable<CAPACITY>::MemoryUsage() const
+{
+    return sizeof(control) + sizeof(table) + arena.MemoryUsage();
+}
+
+#endif // SWISS_HASH_TABLE_HPP
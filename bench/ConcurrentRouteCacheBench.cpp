@@ -0,0 +1,145 @@
+// Route cache throughput from 1 to 32 threads: a RouteCache<> behind a
+// global mutex, a ConcurrentRouteCache with 1 shard and with 16 shards.
+// Every query is a cached ShortestPath (the cache is warmed first), so
+// the run measures the locking, not the searches. Scaling needs as many
+// cores as threads, the hardware concurrency is printed first.
+//
+// Then a miss heavy replay (Zipf log on a hub map, capped cache, 16
+// shards) with the cross shard subpath lookup off and on.
+//
+// g++ -O2 -std=c++17 -I. bench/ConcurrentRouteCacheBench.cpp *.cpp -o ConcurrentRouteCacheBench -pthread
+// ./ConcurrentRouteCacheBench [queries] [replayed queries]
+#include "ConcurrentRouteCache.h"
+#include "MapGenerator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <mutex>
+
+typedef std::pair<std::string, std::string> Query;
+
+enum Mode
+{
+    GLOBAL_LOCK,
+    ONE_SHARD,
+    SIXTEEN_SHARDS
+};
+
+// Million queries per second
+static double Throughput(MultiGraph& graph, const std::vector<Query>& queries,
+                         Mode mode, int threadCount, long long queryCount)
+{
+    RouteCache<> plain(graph);
+    std::mutex global;
+    ConcurrentRouteCache<> sharded(graph, 0, mode == SIXTEEN_SHARDS ? 16 : 1);
+
+    std::vector<int> path;
+    for(size_t i = 0; i < queries.size(); i++)
+    {
+        path.clear();
+        if(mode == GLOBAL_LOCK) plain.ShortestPath(path, queries[i].first, queries[i].second, true);
+        else sharded.ShortestPath(path, queries[i].first, queries[i].second, true);
+    }
+
+    auto worker = [&](int t)
+    {
+        std::mt19937 rng(t);
+        std::uniform_int_distribution<int> pick(0, static_cast<int>(queries.size()) - 1);
+        std::vector<int> route;
+        for(long long i = 0; i < queryCount / threadCount; i++)
+        {
+            const Query& q = queries[pick(rng)];
+            route.clear();
+            if(mode == GLOBAL_LOCK)
+            {
+                std::lock_guard<std::mutex> guard(global);
+                plain.ShortestPath(route, q.first, q.second, true);
+            }
+            else sharded.ShortestPath(route, q.first, q.second, true);
+        }
+    };
+
+    double start = Seconds();
+    std::vector<std::thread> threads;
+    for(int t = 0; t < threadCount; t++) threads.push_back(std::thread(worker, t));
+    for(int t = 0; t < threadCount; t++) threads[t].join();
+    double seconds = Seconds() - start;
+    return queryCount / threadCount * threadCount / seconds / 1e6;
+}
+
+// Thousand queries per second, the threads split the log
+static double Replay(MultiGraph& graph, const std::vector<std::pair<int, int> >& log,
+                     int capacity, bool subpaths, int threadCount, double& subpathRate)
+{
+    ConcurrentRouteCache<> cache(graph, capacity, 16, subpaths);
+    auto worker = [&](int t)
+    {
+        std::vector<int> route;
+        for(size_t i = t; i < log.size(); i += threadCount)
+        {
+            route.clear();
+            cache.ShortestPath(route, VertexName(log[i].first), VertexName(log[i].second), true);
+        }
+    };
+
+    double start = Seconds();
+    std::vector<std::thread> threads;
+    for(int t = 0; t < threadCount; t++) threads.push_back(std::thread(worker, t));
+    for(int t = 0; t < threadCount; t++) threads[t].join();
+    double seconds = Seconds() - start;
+
+    subpathRate = double(cache.Stats().subpathHits) / log.size();
+    return log.size() / seconds / 1e3;
+}
+
+int main(int argc, char** argv)
+{
+    long long queryCount = argc > 1 ? std::atoll(argv[1]) : 2000000;
+    int replayCount = argc > 2 ? std::atoi(argv[2]) : 20000;
+
+    GeneratedMap map = GeometricMap(3000, 5, 1);
+    const char* path = "ConcurrentRouteCacheBench.map";
+    map.Write(path);
+    MultiGraph graph(path);
+    std::remove(path);
+
+    // Reachable pairs only, an unreachable pair is searched every time
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> vertex(0, map.VertexCount() - 1);
+    std::vector<Query> queries;
+    for(int i = 0; i < 4000; i++)
+    {
+        Query q(VertexName(vertex(rng)), VertexName(vertex(rng)));
+        std::vector<int> route;
+        if(graph.HeuristicShortestPath(route, q.first, q.second, 0.0f)) queries.push_back(q);
+    }
+
+    std::printf("geometric 3k V, %zu cached pairs, %lld queries, hardware concurrency %u\n",
+                queries.size(), queryCount, std::thread::hardware_concurrency());
+    std::printf("  threads  global lock  1 shard  16 shards   (Mqueries/s)\n");
+    const int threadCounts[] = {1, 2, 4, 8, 16, 32};
+    for(int threads : threadCounts)
+    {
+        std::printf("  %7d  %11.2f  %7.2f  %9.2f\n", threads,
+                    Throughput(graph, queries, GLOBAL_LOCK, threads, queryCount),
+                    Throughput(graph, queries, ONE_SHARD, threads, queryCount),
+                    Throughput(graph, queries, SIXTEEN_SHARDS, threads, queryCount));
+    }
+
+    GeneratedMap hubMap = HubMap(40, 2500, 11);
+    hubMap.Write(path);
+    MultiGraph hubGraph(path);
+    std::remove(path);
+    std::vector<std::pair<int, int> > log = ZipfQueryLog(hubMap.VertexCount(), replayCount, 1.0, 40, 9);
+
+    std::printf("hub map 40 + 2500 V, %d replayed queries, capacity 4000, 16 shards\n", replayCount);
+    std::printf("  threads  subpaths off  subpaths on  (kqueries/s)  subpath hits\n");
+    for(int threads : threadCounts)
+    {
+        double offRate, onRate;
+        double off = Replay(hubGraph, log, 4000, false, threads, offRate);
+        double on = Replay(hubGraph, log, 4000, true, threads, onRate);
+        std::printf("  %7d  %12.2f  %11.2f  %26.1f%%\n", threads, off, on, onRate * 100);
+    }
+    return 0;
+}
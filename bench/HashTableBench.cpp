@@ -0,0 +1,110 @@
+// Route table lookups: HashTable (quadratic probing, at most 1/2 load)
+// against SwissHashTable (16 byte control groups, up to 7/8 load) on a
+// small and a large table. 3 element routes, random keys; insert, hit
+// and miss are best of 5, churn is a Remove plus an Insert of a new key
+// at the same load. A full table (TableCapFullException) is reported.
+//
+// g++ -O2 -std=c++17 -I. bench/HashTableBench.cpp PathArena.cpp QuerySignature.cpp -o HashTableBench
+// ./HashTableBench
+#include "HashTable.h"
+#include "SwissHashTable.h"
+#include "MapGenerator.h"
+#include <cstdio>
+#include <cmath>
+#include <memory>
+
+struct TableKey
+{
+    int             startInt;
+    int             endInt;
+    QuerySignature  signature;
+};
+
+template<class Table>
+static void Run(const char* name, int slotCount, double load)
+{
+    std::unique_ptr<Table> table(new Table());
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> vertex(0, 999999);
+
+    int count = static_cast<int>(slotCount * load);
+    std::vector<TableKey> keys, missing;
+    for(int i = 0; i < count; i++)
+    {
+        keys.push_back(TableKey{vertex(rng), vertex(rng), QuerySignature(rng() % 2 == 0)});
+        missing.push_back(TableKey{vertex(rng) + 1000000, vertex(rng), QuerySignature(true)});
+    }
+
+    std::vector<int> route(3);
+    route[1] = 1;
+    double start = Seconds();
+    try
+    {
+        for(int i = 0; i < count; i++)
+        {
+            route[0] = keys[i].startInt;
+            route[2] = keys[i].endInt;
+            table->Insert(route, keys[i].signature);
+        }
+    }
+    catch(TableCapFullException&)
+    {
+        std::printf("%-24s load %.2f  full\n", name, load);
+        return;
+    }
+    double insert = (Seconds() - start) / count;
+
+    std::shuffle(keys.begin(), keys.end(), rng);
+    std::vector<int> out;
+    out.reserve(16);
+    long long found = 0;
+    int repeats = std::max(1, 2000000 / count);
+    double hit = INFINITY, miss = INFINITY;
+    for(int best = 0; best < 5; best++)
+    {
+        start = Seconds();
+        for(int r = 0; r < repeats; r++)
+            for(int i = 0; i < count; i++)
+            {
+                out.clear();
+                found += table->Find(out, keys[i].startInt, keys[i].endInt, keys[i].signature);
+            }
+        hit = std::min(hit, (Seconds() - start) / (double(repeats) * count));
+
+        start = Seconds();
+        for(int r = 0; r < repeats; r++)
+            for(int i = 0; i < count; i++)
+            {
+                out.clear();
+                found += table->Find(out, missing[i].startInt, missing[i].endInt, missing[i].signature);
+            }
+        miss = std::min(miss, (Seconds() - start) / (double(repeats) * count));
+    }
+
+    int churnCount = std::min(count, 200000);
+    start = Seconds();
+    for(int i = 0; i < churnCount; i++)
+    {
+        table->Remove(out, keys[i].startInt, keys[i].endInt, keys[i].signature);
+        keys[i].startInt += 2000000;
+        route[0] = keys[i].startInt;
+        route[2] = keys[i].endInt;
+        table->Insert(route, keys[i].signature);
+    }
+    double churn = (Seconds() - start) / churnCount;
+
+    // Every key is found once per best of 5 round
+    std::printf("%-24s load %.2f  insert %6.1f  hit %6.1f  miss %6.1f  churn %6.1f ns  %s\n",
+                name, load, insert * 1e9, hit * 1e9, miss * 1e9, churn * 1e9,
+                found == 5LL * repeats * count ? "" : "LOST KEYS");
+}
+
+int main()
+{
+    const double loads[] = {0.45, 0.75, 0.87};
+    for(double load : loads) Run<HashTable<65521> >("HashTable<65521>", 65521, load);
+    for(double load : loads) Run<SwissHashTable<65536> >("SwissHashTable<65536>", 65536, load);
+    for(double load : loads) Run<HashTable<2097143> >("HashTable<2097143>", 2097143, load);
+    for(double load : loads) Run<SwissHashTable<2097152> >("SwissHashTable<2097152>", 2097152, load);
+    return 0;
+}
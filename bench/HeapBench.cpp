@@ -0,0 +1,109 @@
+// Priority queues of the searches: one-to-all Dijkstra (blend 0.5) with
+// MinPairHeap (lazy deletion), IndexedDaryHeap<float, D> (decrease key)
+// and RadixHeap (monotone keys). The search runs on a CSR copy of the
+// generated map, so only the queue differs. "checksum" (sum of the
+// distances) must be the same on a row.
+//
+// g++ -O2 -std=c++17 -I. bench/HeapBench.cpp -o HeapBench
+// ./HeapBench [searches]
+#include "IntPair.h"
+#include "IndexedHeap.h"
+#include "MapGenerator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+
+struct Csr
+{
+    std::vector<int>    begin;      // [v, v + 1) on "target" and "weight"
+    std::vector<int>    target;
+    std::vector<float>  weight;
+};
+
+static Csr ToCsr(const GeneratedMap& map, float alpha)
+{
+    Csr csr;
+    csr.begin.push_back(0);
+    for(int v = 0; v < map.VertexCount(); v++)
+    {
+        for(size_t j = 0; j < map.outgoing[v].size(); j++)
+        {
+            const MapEdge& e = map.outgoing[v][j];
+            csr.target.push_back(e.endVertexIndex);
+            csr.weight.push_back(e.weight[0] * (1 - alpha) + e.weight[1] * alpha);
+        }
+        csr.begin.push_back(static_cast<int>(csr.target.size()));
+    }
+    return csr;
+}
+
+// Indexed heaps hold a vertex once, the others skip stale entries
+template<class Heap>
+static double Dijkstra(const Csr& csr, Heap& PQ, int source, std::vector<float>& distance,
+                       long long& popCount)
+{
+    distance.assign(csr.begin.size() - 1, std::numeric_limits<float>::infinity());
+    distance[source] = 0;
+    PQ.push(Pair<float, int>{0, source});
+    while(!PQ.empty())
+    {
+        Pair<float, int> top = PQ.top();
+        PQ.pop();
+        popCount++;
+        if(top.key > distance[top.value]) continue;
+
+        for(int k = csr.begin[top.value]; k < csr.begin[top.value + 1]; k++)
+        {
+            float d = top.key + csr.weight[k];
+            if(d < distance[csr.target[k]])
+            {
+                distance[csr.target[k]] = d;
+                PQ.push(Pair<float, int>{d, csr.target[k]});
+            }
+        }
+    }
+
+    double checksum = 0;
+    for(size_t v = 0; v < distance.size(); v++)
+        if(std::isfinite(distance[v])) checksum += distance[v];
+    return checksum;
+}
+
+template<class MakeHeap>
+static void Run(const char* name, const Csr& csr, int searchCount, MakeHeap makeHeap)
+{
+    int vertexCount = static_cast<int>(csr.begin.size()) - 1;
+    std::vector<float> distance;
+    long long popCount = 0;
+    double checksum = 0;
+    double start = Seconds();
+    for(int s = 0; s < searchCount; s++)
+    {
+        auto PQ = makeHeap(vertexCount);
+        checksum += Dijkstra(csr, PQ, (s * 7919) % vertexCount, distance, popCount);
+    }
+    double seconds = Seconds() - start;
+    std::printf("  %-16s %7.2f ms/search  pops/search %8lld  checksum %.6g\n",
+                name, seconds / searchCount * 1e3, popCount / searchCount, checksum);
+}
+
+static void RunAll(const char* title, const GeneratedMap& map, int searchCount)
+{
+    Csr csr = ToCsr(map, 0.5f);
+    std::printf("%s\n", title);
+    Run("MinPairHeap", csr, searchCount, [](int) { return MinPairHeap<float, int>(); });
+    Run("IndexedDary<2>", csr, searchCount, [](int n) { return IndexedDaryHeap<float, 2>(n); });
+    Run("IndexedDary<4>", csr, searchCount, [](int n) { return IndexedDaryHeap<float, 4>(n); });
+    Run("IndexedDary<8>", csr, searchCount, [](int n) { return IndexedDaryHeap<float, 8>(n); });
+    Run("RadixHeap", csr, searchCount, [](int) { return RadixHeap(); });
+}
+
+int main(int argc, char** argv)
+{
+    int searchCount = argc > 1 ? std::atoi(argv[1]) : 200;
+
+    RunAll("geometric 20k V, k 5", GeometricMap(20000, 5, 1), searchCount);
+    RunAll("random 20k V / 100k E", RandomMap(20000, 100000, 1), searchCount);
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Text map loading: the MultiGraph(filePath) loader against the old
+// line by line loader (getline, istringstream, InsertVertex/AddEdge).
+// Both graphs must have the same vertex and edge order and answer the
+// same routes. The parallel path needs a file over 1 MB and more than
+// one hardware thread.
+//
+// g++ -O2 -std=c++17 -I. bench/LoadBench.cpp *.cpp -o LoadBench -pthread
+// ./LoadBench [map file]   (default: generated maps)
+#include "MultiGraph.h"
+#include "MapGenerator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <thread>
+
+static void LineByLineLoad(MultiGraph& graph, const std::string& filePath)
+{
+    std::ifstream file(filePath.c_str());
+    std::string line;
+    std::string tokens[5];
+    while(std::getline(file, line))
+    {
+        int count = 0;
+        std::istringstream stream(line);
+        while(count < 5 && stream >> tokens[count]) count++;
+        if(count == 0) continue;
+        if(count == 1) graph.InsertVertex(tokens[0]);
+        else if(count == 5)
+            graph.AddEdge(tokens[2], tokens[0], tokens[1],
+                          static_cast<float>(std::atof(tokens[3].c_str())),
+                          static_cast<float>(std::atof(tokens[4].c_str())));
+        else std::cout << "Token Size Mismatch" << std::endl;
+    }
+}
+
+static bool SameGraph(const MultiGraph& a, const MultiGraph& b)
+{
+    FrozenGraph x = a.Freeze();
+    FrozenGraph y = b.Freeze();
+    if(x.VertexCount() != y.VertexCount() || x.EdgeCount() != y.EdgeCount()) return false;
+    for(int v = 0; v < x.VertexCount(); v++)
+        if(x.VertexName(v) != y.VertexName(v)) return false;
+    if(a.EdgeNameCount() != b.EdgeNameCount()) return false;
+    for(int n = 0; n < a.EdgeNameCount(); n++)
+        if(a.EdgeName(n) != b.EdgeName(n)) return false;
+
+    // Edge order and weights, routes hold the edge slots
+    std::mt19937 rng(9);
+    std::uniform_int_distribution<int> vertex(0, x.VertexCount() - 1);
+    for(int q = 0; q < 50; q++)
+    {
+        std::string from = x.VertexName(vertex(rng));
+        std::string to = x.VertexName(vertex(rng));
+        std::vector<int> routeA, routeB;
+        a.HeuristicShortestPath(routeA, from, to, 0.3f);
+        b.HeuristicShortestPath(routeB, from, to, 0.3f);
+        if(routeA != routeB) return false;
+    }
+    return true;
+}
+
+static void Run(const char* title, const std::string& filePath)
+{
+    double start = Seconds();
+    MultiGraph lineByLine;
+    LineByLineLoad(lineByLine, filePath);
+    double middle = Seconds();
+    MultiGraph mapped(filePath);
+    double end = Seconds();
+
+    std::printf("%-28s line by line %6.3f s  loader %6.3f s  same %s\n",
+                title, middle - start, end - middle,
+                SameGraph(lineByLine, mapped) ? "yes" : "NO");
+}
+
+int main(int argc, char** argv)
+{
+    std::printf("hardware concurrency %u\n", std::thread::hardware_concurrency());
+    if(argc > 1)
+    {
+        Run(argv[1], argv[1]);
+        return 0;
+    }
+
+    const char* path = "LoadBench.map";
+    RandomMap(20000, 100000, 1).Write(path);
+    Run("random 20k V / 100k E", path);
+    RandomMap(200000, 1200000, 1).Write(path);
+    Run("random 200k V / 1.2M E", path);
+    std::remove(path);
+    return 0;
+}
@@ -0,0 +1,79 @@
+// Distance matrix: ManyToManyDistances (with paths) on 1 to 32 worker
+// threads, against one HeuristicShortestPath call per pair. Distances
+// must match the pairwise costs. Scaling needs as many cores as threads,
+// the hardware concurrency is printed first.
+//
+// g++ -O2 -std=c++17 -I. bench/ManyToManyBench.cpp *.cpp -o ManyToManyBench -pthread
+// ./ManyToManyBench [origins = destinations] [repeats]
+#include "MultiGraph.h"
+#include "MapGenerator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <thread>
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 40;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 3;
+    const float alpha = 0.5f;
+
+    GeneratedMap map = GeometricMap(20000, 5, 1);
+    const char* path = "ManyToManyBench.map";
+    map.Write(path);
+    MultiGraph graph(path);
+    std::remove(path);
+
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> vertex(0, map.VertexCount() - 1);
+    std::vector<std::string> origins, destinations;
+    for(int i = 0; i < count; i++)
+    {
+        origins.push_back(VertexName(vertex(rng)));
+        destinations.push_back(VertexName(vertex(rng)));
+    }
+
+    std::printf("geometric 20k V, %dx%d matrix with paths, hardware concurrency %u\n",
+                count, count, std::thread::hardware_concurrency());
+
+    std::vector<float> distances;
+    std::vector<std::vector<int> > paths;
+    double single = 0;
+    const int threadCounts[] = {1, 2, 4, 8, 16, 32};
+    for(int threads : threadCounts)
+    {
+        // Best of "repeats"
+        double best = INFINITY;
+        for(int r = 0; r < repeats; r++)
+        {
+            double start = Seconds();
+            graph.ManyToManyDistances(distances, origins, destinations, alpha, threads, &paths);
+            best = std::min(best, Seconds() - start);
+        }
+        if(threads == 1) single = best;
+        std::printf("  %2d threads  %8.3f s  speedup %5.2f\n", threads, best, single / best);
+    }
+
+    int mismatches = 0;
+    double start = Seconds();
+    for(int i = 0; i < count; i++)
+        for(int j = 0; j < count; j++)
+        {
+            std::vector<int> route;
+            bool found = graph.HeuristicShortestPath(route, origins[i], destinations[j], alpha);
+            float distance = distances[i * count + j];
+            if(found != std::isfinite(distance))
+            {
+                mismatches++;
+                continue;
+            }
+            if(!found) continue;
+            double w0, w1;
+            map.RouteWeights(w0, w1, route);
+            double cost = w0 * (1 - alpha) + w1 * alpha;
+            if(std::abs(cost - distance) > 1e-3 * std::max(1.0, cost)) mismatches++;
+        }
+    std::printf("  pairwise    %8.3f s  (%d HeuristicShortestPath calls)  mismatches %d\n",
+                Seconds() - start, count * count, mismatches);
+    return 0;
+}
@@ -0,0 +1,304 @@
+#ifndef MAP_GENERATOR_H
+#define MAP_GENERATOR_H
+
+#include <vector>
+#include <string>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+
+// Synthetic maps of the benchmarks (bench/*.cpp), header only so every
+// benchmark builds with a single g++ line.
+//
+// A map is generated in memory, then written in the text map format
+// (vertex lines, then "from to edgeName weight0 weight1" lines) and
+// loaded with MultiGraph(filePath). Edges are written grouped by their
+// start vertex, the loader keeps that order, so the edge slot of an
+// orderedVertexEdgeIndexList is the index on "outgoing" and a route can
+// be costed without the graph internals (RouteWeights).
+//
+// Vertex names are "V<index>". Weights are rounded to two decimals, the
+// loaded graph has the same values.
+//
+// USAGE:
+//
+// GeneratedMap map = GeometricMap(20000, 5, 1);
+// map.Write("geo.txt");
+// MultiGraph graph("geo.txt");
+struct MapEdge
+{
+    int         endVertexIndex;
+    std::string name;
+    float       weight[2];
+};
+
+struct GeneratedMap
+{
+    std::vector<std::vector<MapEdge> > outgoing;    // [vertex][edge slot]
+
+    int         VertexCount() const { return static_cast<int>(outgoing.size()); }
+    int         EdgeCount() const
+    {
+        int count = 0;
+        for(size_t i = 0; i < outgoing.size(); i++) count += static_cast<int>(outgoing[i].size());
+        return count;
+    }
+
+    // Same named edges must end on different vertices (MultiGraph::AddEdge),
+    // returns false for a duplicate
+    bool        AddEdge(int from, int to, const std::string& name, float weight0, float weight1)
+    {
+        std::vector<MapEdge>& edges = outgoing[from];
+        for(size_t j = 0; j < edges.size(); j++)
+            if(edges[j].endVertexIndex == to && edges[j].name == name) return false;
+
+        MapEdge edge;
+        edge.endVertexIndex = to;
+        edge.name = name;
+        edge.weight[0] = std::round(weight0 * 100.0f) / 100.0f;
+        edge.weight[1] = std::round(weight1 * 100.0f) / 100.0f;
+        edges.push_back(edge);
+        return true;
+    }
+
+    // Mirrors MultiGraph::RemoveEdge, later slots shift down
+    void        RemoveEdge(int from, int slot)
+    {
+        outgoing[from].erase(outgoing[from].begin() + slot);
+    }
+
+    bool        Write(const std::string& filePath) const
+    {
+        FILE* file = std::fopen(filePath.c_str(), "w");
+        if(!file) return false;
+        for(int i = 0; i < VertexCount(); i++) std::fprintf(file, "V%d\n", i);
+        for(int i = 0; i < VertexCount(); i++)
+            for(size_t j = 0; j < outgoing[i].size(); j++)
+            {
+                const MapEdge& e = outgoing[i][j];
+                std::fprintf(file, "V%d V%d %s %.2f %.2f\n", i, e.endVertexIndex,
+                             e.name.c_str(), e.weight[0], e.weight[1]);
+            }
+        return std::fclose(file) == 0;
+    }
+
+    // Total weights of a route, false if it is not a route of the map
+    bool        RouteWeights(double& weight0, double& weight1,
+                             const std::vector<int>& orderedVertexEdgeIndexList) const
+    {
+        const std::vector<int>& route = orderedVertexEdgeIndexList;
+        weight0 = weight1 = 0;
+        if(route.empty() || route.size() % 2 == 0) return false;
+        for(size_t i = 0; i + 2 < route.size(); i += 2)
+        {
+            if(route[i] < 0 || route[i] >= VertexCount()) return false;
+            const std::vector<MapEdge>& edges = outgoing[route[i]];
+            if(route[i + 1] < 0 || route[i + 1] >= static_cast<int>(edges.size())) return false;
+            const MapEdge& e = edges[route[i + 1]];
+            if(e.endVertexIndex != route[i + 2]) return false;
+            weight0 += e.weight[0];
+            weight1 += e.weight[1];
+        }
+        return true;
+    }
+};
+
+inline std::string VertexName(int vertexIndex)
+{
+    return "V" + std::to_string(vertexIndex);
+}
+
+inline std::string AirlineName(int airline)
+{
+    return "A" + std::to_string(airline);
+}
+
+// "edgeCount" edges between uniformly random vertex pairs, integer
+// weights in [1, 50], 8 airlines. No locality, searches settle a large
+// part of the graph.
+inline GeneratedMap RandomMap(int vertexCount, int edgeCount, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> vertex(0, vertexCount - 1);
+    std::uniform_int_distribution<int> airline(0, 7);
+    std::uniform_int_distribution<int> weight(1, 50);
+
+    GeneratedMap map;
+    map.outgoing.resize(vertexCount);
+    for(int count = 0; count < edgeCount;)
+    {
+        int from = vertex(rng);
+        int to = vertex(rng);
+        if(from == to) continue;
+        // One edge per ordered pair
+        bool exists = false;
+        for(size_t j = 0; j < map.outgoing[from].size(); j++)
+            if(map.outgoing[from][j].endVertexIndex == to) exists = true;
+        if(exists) continue;
+
+        float w0 = weight(rng);
+        float w1 = weight(rng);
+        map.AddEdge(from, to, AirlineName(airline(rng)), w0, w1);
+        count++;
+    }
+    return map;
+}
+
+// Road like map, points on the unit square linked to their
+// "neighbourCount" nearest neighbours. weight[1] is the distance (x1000),
+// weight[0] the distance times a random factor in [0.5, 2], so the two
+// criteria disagree.
+inline GeneratedMap GeometricMap(int vertexCount, int neighbourCount, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> factor(0.5f, 2.0f);
+    std::uniform_int_distribution<int> airline(0, 7);
+
+    std::vector<float> x(vertexCount), y(vertexCount);
+    for(int i = 0; i < vertexCount; i++)
+    {
+        x[i] = unit(rng);
+        y[i] = unit(rng);
+    }
+
+    // About 4 points per grid cell, neighbours are searched on the 3x3 block
+    int grid = static_cast<int>(std::sqrt(vertexCount / 4.0)) + 1;
+    std::vector<std::vector<int> > cells(grid * grid);
+    auto Cell = [&](float c) { return std::min(static_cast<int>(c * grid), grid - 1); };
+    for(int i = 0; i < vertexCount; i++) cells[Cell(y[i]) * grid + Cell(x[i])].push_back(i);
+
+    GeneratedMap map;
+    map.outgoing.resize(vertexCount);
+    std::vector<std::pair<float, int> > candidates;
+    for(int i = 0; i < vertexCount; i++)
+    {
+        candidates.clear();
+        int cx = Cell(x[i]);
+        int cy = Cell(y[i]);
+        for(int dy = -1; dy <= 1; dy++)
+            for(int dx = -1; dx <= 1; dx++)
+            {
+                if(cx + dx < 0 || cx + dx >= grid || cy + dy < 0 || cy + dy >= grid) continue;
+                const std::vector<int>& cell = cells[(cy + dy) * grid + cx + dx];
+                for(size_t k = 0; k < cell.size(); k++)
+                {
+                    int j = cell[k];
+                    if(j == i) continue;
+                    float d = std::hypot(x[j] - x[i], y[j] - y[i]);
+                    candidates.push_back(std::make_pair(d, j));
+                }
+            }
+
+        int count = std::min(neighbourCount, static_cast<int>(candidates.size()));
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+        for(int k = 0; k < count; k++)
+        {
+            float d = candidates[k].first * 1000.0f;
+            map.AddEdge(i, candidates[k].second, AirlineName(airline(rng)),
+                        d * factor(rng), d);
+        }
+    }
+    return map;
+}
+
+// Airline like map: "hubCount" hubs (vertices 0 .. hubCount - 1) linked
+// to each other, every spoke linked both ways to its 1 or 2 nearest hubs,
+// 5% of the spokes also linked to a random spoke ("R"). Most routes go
+// through a hub, so cached routes share many subpaths. weight[0] is the
+// distance (x1000), weight[1] the distance times [0.6, 1.6] plus 20.
+inline GeneratedMap HubMap(int hubCount, int spokeCount, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> factor(0.6f, 1.6f);
+    int vertexCount = hubCount + spokeCount;
+
+    std::vector<float> x(vertexCount), y(vertexCount);
+    for(int i = 0; i < vertexCount; i++)
+    {
+        x[i] = unit(rng);
+        y[i] = unit(rng);
+    }
+    auto Distance = [&](int a, int b) { return std::hypot(x[a] - x[b], y[a] - y[b]) * 1000.0f; };
+
+    GeneratedMap map;
+    map.outgoing.resize(vertexCount);
+    auto Link = [&](int a, int b, const std::string& name)
+    {
+        float d = Distance(a, b);
+        map.AddEdge(a, b, name, d, d * factor(rng) + 20.0f);
+    };
+
+    for(int a = 0; a < hubCount; a++)
+        for(int b = 0; b < hubCount; b++)
+            if(a != b) Link(a, b, AirlineName(a % 5));
+
+    std::vector<std::pair<float, int> > hubs(hubCount);
+    for(int s = hubCount; s < vertexCount; s++)
+    {
+        for(int h = 0; h < hubCount; h++) hubs[h] = std::make_pair(Distance(s, h), h);
+        int count = std::min(unit(rng) < 1.0f / 3 ? 2 : 1, hubCount);
+        std::partial_sort(hubs.begin(), hubs.begin() + count, hubs.end());
+        for(int k = 0; k < count; k++)
+        {
+            int h = hubs[k].second;
+            Link(s, h, AirlineName(h % 5));
+            Link(h, s, AirlineName(h % 5));
+        }
+        if(unit(rng) < 0.05f)
+        {
+            int t = hubCount + static_cast<int>(unit(rng) * spokeCount) % spokeCount;
+            if(t == s) continue;
+            Link(s, t, "R");
+            Link(t, s, "R");
+        }
+    }
+    return map;
+}
+
+// Replayed query log, (start vertex, end vertex) pairs. Vertex
+// popularity is Zipf ("exponent"), the first "topCount" vertices are the
+// most popular ones in order (hubs), the others get a random rank.
+inline std::vector<std::pair<int, int> > ZipfQueryLog(int vertexCount, int queryCount,
+                                                      double exponent, int topCount,
+                                                      unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<int> byRank(vertexCount);
+    for(int i = 0; i < vertexCount; i++) byRank[i] = i;
+    std::shuffle(byRank.begin() + std::min(topCount, vertexCount), byRank.end(), rng);
+
+    std::vector<double> cumulative(vertexCount);
+    double sum = 0;
+    for(int r = 0; r < vertexCount; r++)
+    {
+        sum += 1.0 / std::pow(r + 1.0, exponent);
+        cumulative[r] = sum;
+    }
+    std::uniform_real_distribution<double> unit(0.0, sum);
+    auto Pick = [&]()
+    {
+        size_t r = std::lower_bound(cumulative.begin(), cumulative.end(), unit(rng)) - cumulative.begin();
+        return byRank[std::min(r, cumulative.size() - 1)];
+    };
+
+    std::vector<std::pair<int, int> > log;
+    while(static_cast<int>(log.size()) < queryCount)
+    {
+        int from = Pick();
+        int to = Pick();
+        if(from != to) log.push_back(std::make_pair(from, to));
+    }
+    return log;
+}
+
+// Wall clock of the benchmarks
+inline double Seconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // MAP_GENERATOR_H
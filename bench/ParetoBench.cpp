@@ -0,0 +1,94 @@
+// Bi-criteria search: ParetoShortestPaths against HeuristicShortestPath
+// at 101 blends. Every supported optimum must be on the frontier, a
+// capped frontier (maxLabelsPerVertex) may miss some ("inexact").
+//
+// g++ -O2 -std=c++17 -I. bench/ParetoBench.cpp *.cpp -o ParetoBench -pthread
+// ./ParetoBench [queries]
+#include "MultiGraph.h"
+#include "MapGenerator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <climits>
+
+static void Run(const char* title, const GeneratedMap& map, int maxLabels, int queryCount)
+{
+    const char* path = "ParetoBench.map";
+    map.Write(path);
+    MultiGraph graph(path);
+    std::remove(path);
+
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> vertex(0, map.VertexCount() - 1);
+
+    int answered = 0;
+    int inexact = 0;
+    int invalid = 0;
+    long long frontierSize = 0;
+    long long labels = 0;
+    double paretoSeconds = 0;
+    double blendSeconds = 0;
+    for(int q = 0; q < queryCount; q++)
+    {
+        std::string from = VertexName(vertex(rng));
+        std::string to = VertexName(vertex(rng));
+        if(from == to) continue;
+
+        std::vector<ParetoPath> frontier;
+        SearchStats stats;
+        double start = Seconds();
+        bool found = graph.ParetoShortestPaths(frontier, from, to, maxLabels, &stats);
+        paretoSeconds += Seconds() - start;
+        if(!found) continue;
+        answered++;
+        frontierSize += frontier.size();
+        labels += stats.settledCount;
+
+        // Reported weights are the weights of the route
+        for(size_t i = 0; i < frontier.size(); i++)
+        {
+            double w0, w1;
+            if(!map.RouteWeights(w0, w1, frontier[i].orderedVertexEdgeIndexList) ||
+               std::abs(w0 - frontier[i].weight0) > 1e-2 * std::max(1.0, w0) ||
+               std::abs(w1 - frontier[i].weight1) > 1e-2 * std::max(1.0, w1))
+                invalid++;
+        }
+
+        bool exact = true;
+        for(int k = 0; k <= 100; k++)
+        {
+            float alpha = k / 100.0f;
+            std::vector<int> route;
+            start = Seconds();
+            graph.HeuristicShortestPath(route, from, to, alpha);
+            blendSeconds += Seconds() - start;
+
+            double w0, w1;
+            map.RouteWeights(w0, w1, route);
+            double cost = w0 * (1 - alpha) + w1 * alpha;
+            double best = INFINITY;
+            for(size_t i = 0; i < frontier.size(); i++)
+                best = std::min(best, frontier[i].weight0 * (1.0 - alpha) + frontier[i].weight1 * alpha);
+            if(std::abs(best - cost) > 1e-3 * std::max(1.0, cost)) exact = false;
+        }
+        if(!exact) inexact++;
+    }
+
+    if(answered == 0) answered = 1;
+    std::printf("%-30s frontier %6.1f  labels %8.1f  pareto %8.2f ms  101 blends %8.2f ms  "
+                "inexact %d/%d  invalid %d\n",
+                title, double(frontierSize) / answered, double(labels) / answered,
+                paretoSeconds / answered * 1e3, blendSeconds / answered * 1e3,
+                inexact, answered, invalid);
+}
+
+int main(int argc, char** argv)
+{
+    int queryCount = argc > 1 ? std::atoi(argv[1]) : 20;
+
+    Run("random 200 V / 800 E, cap 64", RandomMap(200, 800, 1), 64, queryCount * 10);
+    GeneratedMap geometric = GeometricMap(20000, 5, 1);
+    Run("geometric 20k V, no cap", geometric, INT_MAX, queryCount);
+    Run("geometric 20k V, cap 64", geometric, 64, queryCount);
+    return 0;
+}
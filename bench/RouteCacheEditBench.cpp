@@ -0,0 +1,148 @@
+// Route cache hit rate under graph edits: batches of random AddEdge /
+// RemoveEdge edits made through the cache, with queries in between, on a
+// generated geometric map. Compared with invalidating the whole table
+// after every batch, with and without landmark tables, and with the
+// tables prepared again after every batch (MultiGraph::AddEdge drops
+// them). Batches of 1 edit and of 10 edits; the second AddEdge of a batch
+// has no landmark bounds left. Sampled cache hits are checked against a
+// fresh search (same cost).
+//
+// g++ -O2 -std=c++17 -I. bench/RouteCacheEditBench.cpp *.cpp -o RouteCacheEditBench -pthread
+// ./RouteCacheEditBench [edits]
+#include "RouteCache.h"
+#include "MapGenerator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+enum Mode
+{
+    FULL_INVALIDATION,
+    NO_LANDMARKS,
+    LANDMARKS_ONCE,
+    LANDMARKS_EVERY_BATCH
+};
+
+static const char* ModeName(Mode mode)
+{
+    switch(mode)
+    {
+        case FULL_INVALIDATION: return "full invalidation";
+        case NO_LANDMARKS:      return "tracked, no landmarks";
+        case LANDMARKS_ONCE:    return "tracked, landmarks once";
+        default:                return "tracked, landmarks per batch";
+    }
+}
+
+static void Run(const GeneratedMap& original, Mode mode, int editCount, int batchSize)
+{
+    // The map is edited along with the graph, routes are costed on it
+    GeneratedMap map = original;
+    const char* path = "RouteCacheEditBench.map";
+    map.Write(path);
+    MultiGraph graph(path);
+    std::remove(path);
+
+    const std::vector<float> blends = {0.0f, 1.0f};
+    const int landmarkCount = 8;
+    if(mode == LANDMARKS_ONCE || mode == LANDMARKS_EVERY_BATCH)
+        graph.PrepareLandmarks(landmarkCount, blends);
+
+    RouteCache<> cache(graph);
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> vertex(0, map.VertexCount() - 1);
+    std::vector<std::pair<int, int> > pairs;
+    for(int i = 0; i < 600; i++) pairs.push_back(std::make_pair(vertex(rng), vertex(rng)));
+    std::uniform_int_distribution<int> pick(0, static_cast<int>(pairs.size()) - 1);
+    std::uniform_real_distribution<float> weight(5.0f, 40.0f);
+    // Same queries and edits on every mode, whatever the hits
+    std::mt19937 editRng(6), checkRng(7);
+
+    long long queries = 0, hits = 0, evicted = 0;
+    int checked = 0, mismatches = 0, newEdges = 0;
+    double editSeconds = 0;
+    for(int e = 0; e < editCount; e += batchSize)
+    {
+        for(int q = 0; q < 200; q++)
+        {
+            const std::pair<int, int>& p = pairs[pick(rng)];
+            bool isCostWeighted = rng() % 2 == 0;
+            std::vector<int> route;
+            bool hit = cache.Find(route, p.first, p.second, isCostWeighted);
+            queries++;
+            if(hit && checked < 2000 && checkRng() % 8 == 0)
+            {
+                float alpha = isCostWeighted ? 0.0f : 1.0f;
+                std::vector<int> searched;
+                graph.HeuristicShortestPath(searched, VertexName(p.first), VertexName(p.second), alpha);
+                double w0, w1, s0, s1;
+                bool valid = map.RouteWeights(w0, w1, route) && map.RouteWeights(s0, s1, searched);
+                double cost = alpha == 0 ? w0 : w1;
+                double best = alpha == 0 ? s0 : s1;
+                if(!valid || std::abs(cost - best) > 1e-2 * std::max(1.0, best)) mismatches++;
+                checked++;
+            }
+            if(hit) hits++;
+            else
+            {
+                route.clear();
+                cache.ShortestPath(route, VertexName(p.first), VertexName(p.second), isCostWeighted);
+            }
+        }
+
+        double start = Seconds();
+        int before = cache.RouteCount();
+        for(int b = 0; b < batchSize; b++)
+        {
+            int u = vertex(editRng);
+            if(editRng() % 2 == 0)
+            {
+                // New road two hops away
+                if(map.outgoing[u].empty()) continue;
+                int w = map.outgoing[u][editRng() % map.outgoing[u].size()].endVertexIndex;
+                if(map.outgoing[w].empty()) continue;
+                int v = map.outgoing[w][editRng() % map.outgoing[w].size()].endVertexIndex;
+                std::string name = "N" + std::to_string(newEdges++);
+                float w0 = weight(editRng), w1 = weight(editRng);
+                if(u == v || !map.AddEdge(u, v, name, w0, w1)) continue;
+                const MapEdge& added = map.outgoing[u].back();
+                cache.AddEdge(name, VertexName(u), VertexName(v), added.weight[0], added.weight[1]);
+            }
+            else
+            {
+                if(map.outgoing[u].empty()) continue;
+                int slot = editRng() % map.outgoing[u].size();
+                MapEdge removed = map.outgoing[u][slot];
+                map.RemoveEdge(u, slot);
+                cache.RemoveEdge(removed.name, VertexName(u), VertexName(removed.endVertexIndex));
+            }
+        }
+        if(mode == FULL_INVALIDATION) cache.InvalidateTable();
+        if(mode == LANDMARKS_EVERY_BATCH) graph.PrepareLandmarks(landmarkCount, blends);
+        evicted += before - cache.RouteCount();
+        editSeconds += Seconds() - start;
+    }
+
+    int batches = (editCount + batchSize - 1) / batchSize;
+    std::printf("  %-30s hit %5.1f%%  evicted/batch %6.1f  edit %7.2f ms/batch  checked %d mismatches %d\n",
+                ModeName(mode), 100.0 * hits / queries, double(evicted) / batches,
+                editSeconds / batches * 1e3, checked, mismatches);
+}
+
+int main(int argc, char** argv)
+{
+    int editCount = argc > 1 ? std::atoi(argv[1]) : 200;
+    GeneratedMap map = GeometricMap(3000, 5, 1);
+
+    const int batchSizes[] = {1, 10};
+    for(int batchSize : batchSizes)
+    {
+        std::printf("geometric 3k V, %d edits in batches of %d, 200 queries per batch\n",
+                    editCount, batchSize);
+        Run(map, FULL_INVALIDATION, editCount, batchSize);
+        Run(map, NO_LANDMARKS, editCount, batchSize);
+        Run(map, LANDMARKS_ONCE, editCount, batchSize);
+        Run(map, LANDMARKS_EVERY_BATCH, editCount, batchSize);
+    }
+    return 0;
+}
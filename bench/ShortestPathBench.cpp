@@ -0,0 +1,77 @@
+// Point-to-point searches: early stopping Dijkstra (FilteredShortestPath)
+// against BiDirectionalShortestPath on random queries, settled vertices,
+// time per query and route costs (they must match).
+//
+// g++ -O2 -std=c++17 -I. bench/ShortestPathBench.cpp *.cpp -o ShortestPathBench -pthread
+// ./ShortestPathBench [queries]
+#include "MultiGraph.h"
+#include "MapGenerator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+static void Run(const char* title, const GeneratedMap& map, int queryCount)
+{
+    const char* path = "ShortestPathBench.map";
+    map.Write(path);
+    MultiGraph graph(path);
+    std::remove(path);
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> vertex(0, map.VertexCount() - 1);
+    std::uniform_int_distribution<int> blend(0, 4);
+    const std::vector<std::string> noFilter;
+
+    long long settled[2] = {0, 0};
+    double seconds[2] = {0, 0};
+    int mismatches = 0;
+    for(int q = 0; q < queryCount; q++)
+    {
+        std::string from = VertexName(vertex(rng));
+        std::string to = VertexName(vertex(rng));
+        float alpha = blend(rng) / 4.0f;
+
+        std::vector<int> route[2];
+        SearchStats stats[2];
+        bool found[2];
+        double start = Seconds();
+        found[0] = graph.FilteredShortestPath(route[0], from, to, alpha, noFilter, &stats[0]);
+        double middle = Seconds();
+        found[1] = graph.BiDirectionalShortestPath(route[1], from, to, alpha, noFilter, &stats[1]);
+        double end = Seconds();
+
+        seconds[0] += middle - start;
+        seconds[1] += end - middle;
+        settled[0] += stats[0].settledCount;
+        settled[1] += stats[1].settledCount;
+
+        if(found[0] != found[1])
+        {
+            mismatches++;
+            continue;
+        }
+        if(!found[0]) continue;
+        double cost[2];
+        for(int k = 0; k < 2; k++)
+        {
+            double w0, w1;
+            cost[k] = map.RouteWeights(w0, w1, route[k]) ? w0 * (1 - alpha) + w1 * alpha : -1;
+        }
+        if(cost[0] < 0 || std::abs(cost[0] - cost[1]) > 1e-3 * std::max(1.0, cost[0])) mismatches++;
+    }
+
+    std::printf("%-24s settled/query  early stop %8.1f  bidirectional %8.1f\n",
+                title, double(settled[0]) / queryCount, double(settled[1]) / queryCount);
+    std::printf("%-24s us/query       early stop %8.1f  bidirectional %8.1f  mismatches %d\n",
+                "", seconds[0] / queryCount * 1e6, seconds[1] / queryCount * 1e6, mismatches);
+}
+
+int main(int argc, char** argv)
+{
+    int queryCount = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    Run("random 200 V / 800 E", RandomMap(200, 800, 1), queryCount);
+    Run("random 20k V / 100k E", RandomMap(20000, 100000, 1), queryCount);
+    Run("geometric 20k V, k 5", GeometricMap(20000, 5, 1), queryCount);
+    return 0;
+}
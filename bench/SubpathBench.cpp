@@ -0,0 +1,92 @@
+// Subpath answers of the route cache: replays a Zipf query log on a hub
+// and spoke map through a capped RouteCache, with exact key hits only
+// and with FindSubpath tried before searching. Reports hit rates and the
+// latency of each kind of answer; sampled subpath answers are checked
+// against a fresh search (same cost).
+//
+// g++ -O2 -std=c++17 -I. bench/SubpathBench.cpp *.cpp -o SubpathBench -pthread
+// ./SubpathBench [queries]
+#include "RouteCache.h"
+#include "MapGenerator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+static void Replay(const char* title, MultiGraph& graph, const GeneratedMap& map,
+                   const std::vector<std::pair<int, int> >& log, int capacity, bool subpaths)
+{
+    RouteCache<> cache(graph, capacity);
+    const QuerySignature signature(true);   // weight[0]
+    const std::vector<std::string> noFilter;
+
+    long long count[3] = {0, 0, 0};         // exact hit, subpath hit, search
+    double seconds[3] = {0, 0, 0};
+    int checked = 0;
+    int mismatches = 0;
+    for(size_t q = 0; q < log.size(); q++)
+    {
+        int from = log[q].first;
+        int to = log[q].second;
+        std::vector<int> route;
+        int kind;
+        double start = Seconds();
+        if(cache.Find(route, from, to, signature, true)) kind = 0;
+        else if(subpaths && cache.FindSubpath(route, from, to, signature, true)) kind = 1;
+        else
+        {
+            kind = 2;
+            if(RouteCache<>::Search(graph, route, VertexName(from), VertexName(to), signature, noFilter))
+                cache.Insert(route, signature);
+        }
+        seconds[kind] += Seconds() - start;
+        count[kind]++;
+
+        if(kind == 1 && count[1] % 500 == 0)
+        {
+            std::vector<int> searched;
+            RouteCache<>::Search(graph, searched, VertexName(from), VertexName(to), signature, noFilter);
+            double w0, w1, searchedW0;
+            map.RouteWeights(searchedW0, w1, searched);
+            if(!map.RouteWeights(w0, w1, route) || route.front() != from || route.back() != to ||
+               std::abs(w0 - searchedW0) > 1e-2 * std::max(1.0, w0))
+                mismatches++;
+            checked++;
+        }
+    }
+
+    double n = static_cast<double>(log.size());
+    std::printf("%-34s hit %5.1f%% (subpath %5.1f%%)  avg %6.1f us  exact %5.2f us  "
+                "subpath %5.2f us  search %6.1f us  checked %d mismatches %d\n",
+                title, (count[0] + count[1]) / n * 100, count[1] / n * 100,
+                (seconds[0] + seconds[1] + seconds[2]) / n * 1e6,
+                seconds[0] / std::max(1LL, count[0]) * 1e6,
+                seconds[1] / std::max(1LL, count[1]) * 1e6,
+                seconds[2] / std::max(1LL, count[2]) * 1e6, checked, mismatches);
+}
+
+int main(int argc, char** argv)
+{
+    int queryCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int hubCount = 40;
+
+    GeneratedMap map = HubMap(hubCount, 2500, 11);
+    const char* path = "SubpathBench.map";
+    map.Write(path);
+    MultiGraph graph(path);
+    std::remove(path);
+    std::printf("hub map, %d hubs %d spokes %d edges, %d queries, Zipf(1.0)\n",
+                hubCount, map.VertexCount() - hubCount, map.EdgeCount(), queryCount);
+
+    std::vector<std::pair<int, int> > hubLog = ZipfQueryLog(map.VertexCount(), queryCount, 1.0, hubCount, 9);
+    std::vector<std::pair<int, int> > randomLog = ZipfQueryLog(map.VertexCount(), queryCount, 1.0, 0, 9);
+    const int capacities[] = {4000, 20000};
+    for(int capacity : capacities)
+    {
+        std::printf("capacity %d\n", capacity);
+        Replay("  hubs most popular, exact only", graph, map, hubLog, capacity, false);
+        Replay("  hubs most popular, subpaths", graph, map, hubLog, capacity, true);
+        Replay("  random popularity, exact only", graph, map, randomLog, capacity, false);
+        Replay("  random popularity, subpaths", graph, map, randomLog, capacity, true);
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Round trip of routes through the arena backed tables, odd (vertex
+// ended) and even (edge slot ended) lengths, and through a HashTable
+// with a key policy of another type.
+//
+// g++ -std=c++17 -I. tests/PathArenaTest.cpp PathArena.cpp QuerySignature.cpp -o PathArenaTest
+
+#include <cstdio>
+#include <vector>
+#include <utility>
+#include "HashTable.h"
+#include "SwissHashTable.h"
+
+static int failures = 0;
+
+static void Check(bool condition, const char* what, int length)
+{
+    if(condition) return;
+    printf("FAILED %s (length %d)\n", what, length);
+    failures++;
+}
+
+template<class Table>
+static void RoundTrip(const char* name)
+{
+    QuerySignature signature(true);
+    for(int length = 1; length <= 9; length++)
+    {
+        // Large and negative deltas, large edge slots
+        std::vector<int> route;
+        for(int i = 0; i < length; i++)
+            route.push_back((i % 2 == 0) ? (i * 7919) % 100003 - 50000 : 300 + i * 1000);
+
+        Table* table = new Table;
+        table->Insert(route, signature);
+
+        std::vector<int> out;
+        Check(table->Find(out, route.front(), route.back(), signature) && out == route, name, length);
+
+        PathView view;
+        table->Find(view, route.front(), route.back(), signature);
+        std::vector<int> iterated(view.begin(), view.end());
+        Check(iterated == route && view.Size() == length, "PathView", length);
+
+        std::vector<int> most;
+        table->GetMostInserted(most);
+        Check(most == route, "GetMostInserted", length);
+
+        bool visited = false;
+        table->ForEach([&](const HashData& data) { visited = data.intArray == route; });
+        Check(visited, "ForEach", length);
+
+        std::vector<int> removed;
+        table->Remove(removed, route.front(), route.back(), signature);
+        Check(removed == route, "Remove", length);
+        delete table;
+    }
+}
+
+// Key of another type, (start, end) stored on the record as two varints
+struct PairKeyPolicy
+{
+    typedef std::pair<int, int> Type;
+
+    static const int MAX_ENCODED_SIZE = 2 * PathArena::MAX_VARINT_BYTES;
+
+    static Type Of(int startInt, int endInt, const QuerySignature&) { return Type(startInt, endInt); }
+    static Type Of(const std::vector<int>& intArray, const QuerySignature&) { return Type(intArray.front(), intArray.back()); }
+    static unsigned int Hash(const Type& key) { return key.first * 31u + key.second; }
+    static unsigned int Tag(const Type& key) { return key.first ^ (key.second * 0x9E3779B1u); }
+
+    static int Encode(unsigned char* p, const Type& key)
+    {
+        unsigned char* end = PathArena::PutVarint(p, PathArena::ZigZag(key.first));
+        return PathArena::PutVarint(end, PathArena::ZigZag(key.second)) - p;
+    }
+    static int EncodedSize(const unsigned char* record)
+    {
+        const unsigned char* p = record;
+        PathArena::GetVarint(p);
+        PathArena::GetVarint(p);
+        return p - record;
+    }
+    static bool Matches(const unsigned char* record, const unsigned char*, const Type& key)
+    {
+        Type stored;
+        stored.first = PathArena::UnZigZag(PathArena::GetVarint(record));
+        stored.second = PathArena::UnZigZag(PathArena::GetVarint(record));
+        return stored == key;
+    }
+    static void Decode(const unsigned char* record, const unsigned char*, HashData& data)
+    {
+        data.startInt = PathArena::UnZigZag(PathArena::GetVarint(record));
+        data.endInt = PathArena::UnZigZag(PathArena::GetVarint(record));
+        data.signature = QuerySignature();
+    }
+};
+
+static void PairKeyRoundTrip()
+{
+    HashTable<61, PairKeyPolicy>* table = new HashTable<61, PairKeyPolicy>;
+    std::vector<int> route = {-5, 3, 12, 7};
+    table->Insert(route, PairKeyPolicy::Type(1, 2));
+    table->Insert(route, PairKeyPolicy::Type(2, 1));
+
+    std::vector<int> out;
+    Check(table->Find(out, PairKeyPolicy::Type(1, 2)) && out == route, "PairKeyPolicy Find", 4);
+    Check(!table->Find(out, PairKeyPolicy::Type(1, 3)), "PairKeyPolicy miss", 4);
+
+    int visited = 0;
+    table->ForEach([&](const HashData& data) { visited += data.intArray == route; });
+    Check(visited == 2, "PairKeyPolicy ForEach", 4);
+
+    std::vector<int> removed;
+    table->Remove(removed, PairKeyPolicy::Type(2, 1));
+    Check(removed == route && !table->Find(out, PairKeyPolicy::Type(2, 1)), "PairKeyPolicy Remove", 4);
+    delete table;
+}
+
+int main()
+{
+    RoundTrip<HashTable<1021> >("HashTable");
+    RoundTrip<HashTable<64, RouteKeyPolicy<MixHash>, LinearProbing, ScanEviction> >("HashTable policies");
+    PairKeyRoundTrip();
+    RoundTrip<SwissHashTable<1024> >("SwissHashTable");
+
+    if(failures == 0) printf("PathArenaTest passed\n");
+    return failures == 0 ? 0 : 1;
+}